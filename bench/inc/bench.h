@@ -0,0 +1,131 @@
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//micro benchmark harness
+//
+//a case is a function called with a context pointer, it performs ops operations on bytes bytes each.
+//the number of calls per sample is doubled until a sample lasts BENCH_MIN_TICKS,
+//then BENCH_WARMUP samples are discarded and reps samples are recorded.
+//results are ticks per operation: min, median, 90th and 99th percentiles,
+//printed as one CSV line or one JSON object per case so runs on the same box can be diffed.
+//ticks are TSC cycles on x86 (not core cycles when frequency scaling is active), ns elsewhere.
+
+#ifndef BENCH_REPS
+#define BENCH_REPS 101
+#endif
+
+#ifndef BENCH_WARMUP
+#define BENCH_WARMUP 5
+#endif
+
+#ifndef BENCH_MIN_TICKS
+#define BENCH_MIN_TICKS 20000
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TICKS_UNIT "cycles"
+static uint64_t bench_ticks(void){
+    _mm_lfence();//do not let the timed code move across the read
+    const uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+#else
+#define BENCH_TICKS_UNIT "ns"
+static uint64_t bench_ticks(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec*1000000000+ts.tv_nsec;
+}
+#endif
+
+//keep the compiler from dropping or hoisting the benchmarked work
+#define BENCH_CLOBBER() __asm__ __volatile__("" ::: "memory")
+static volatile uint64_t bench_sink;
+
+typedef void (*bench_func_t)(void *ctx);
+
+typedef enum {
+    BENCH_CSV,
+    BENCH_JSON,
+} bench_format_t;
+
+typedef struct bench_struct {
+    FILE *out;
+    bench_format_t format;
+    const char *filter;     //only cases whose name contains filter are run, 0 for all
+    unsigned int reps;
+    unsigned int n_results;
+    double *samples;
+} bench_t;
+
+static void bench_init(bench_t *b, FILE *out, bench_format_t format, const char *filter, unsigned int reps){
+    b->out = out;
+    b->format = format;
+    b->filter = filter;
+    b->reps = reps ? reps : 1;
+    b->n_results = 0;
+    b->samples = (double*)malloc(b->reps*sizeof(double));
+    if(BENCH_CSV==format) fprintf(out,"name,params,ops,bytes,unit,calls,min,median,p90,p99,bytes_per_tick\n");
+    else fprintf(out,"[\n");
+}
+
+static int bench_cmp_double(const void *a, const void *b){
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+    return (x>y) - (x<y);
+}
+
+static double bench_percentile(const double *sorted, unsigned int n, unsigned int percent){
+    return sorted[(size_t)(n-1)*percent/100];
+}
+
+//time f(ctx) and print one result, params is a free form description ("size=4096 shift=13")
+static void bench_run(bench_t *b, const char *name, const char *params, size_t ops, size_t bytes, bench_func_t f, void *ctx){
+    if(b->filter && (0==strstr(name,b->filter))) return;
+    if(0==ops) ops = 1;
+    uint64_t calls = 1;
+    for(;;){//calibration
+        const uint64_t start = bench_ticks();
+        for(uint64_t i=0;i<calls;i++) f(ctx);
+        const uint64_t t = bench_ticks()-start;
+        if((t>=BENCH_MIN_TICKS) || (calls>=(1ull<<30))) break;
+        calls *= 2;
+    }
+    for(unsigned int r=0;r<BENCH_WARMUP+b->reps;r++){
+        const uint64_t start = bench_ticks();
+        for(uint64_t i=0;i<calls;i++) f(ctx);
+        const uint64_t t = bench_ticks()-start;
+        if(r>=BENCH_WARMUP) b->samples[r-BENCH_WARMUP] = (double)t/(calls*ops);
+    }
+    qsort(b->samples,b->reps,sizeof(double),bench_cmp_double);
+    const double median = bench_percentile(b->samples,b->reps,50);
+    const double p90 = bench_percentile(b->samples,b->reps,90);
+    const double p99 = bench_percentile(b->samples,b->reps,99);
+    const double bytes_per_tick = bytes ? bytes/median : 0;
+    if(BENCH_CSV==b->format){
+        fprintf(b->out,"%s,%s,%zu,%zu,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+            name,params,ops,bytes,BENCH_TICKS_UNIT,(unsigned long long)calls,b->samples[0],median,p90,p99,bytes_per_tick);
+    } else {
+        fprintf(b->out,"%s  {\"name\":\"%s\",\"params\":\"%s\",\"ops\":%zu,\"bytes\":%zu,\"unit\":\"%s\",\"calls\":%llu,"
+            "\"min\":%.3f,\"median\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"bytes_per_tick\":%.3f}",
+            b->n_results ? ",\n" : "",name,params,ops,bytes,BENCH_TICKS_UNIT,(unsigned long long)calls,b->samples[0],median,p90,p99,bytes_per_tick);
+    }
+    fflush(b->out);
+    b->n_results++;
+}
+
+static void bench_finish(bench_t *b){
+    if(BENCH_JSON==b->format) fprintf(b->out,"%s]\n",b->n_results ? "\n" : "");
+    free(b->samples);
+    b->samples = 0;
+}
+
+#endif
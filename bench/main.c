@@ -0,0 +1,383 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+//micro benchmarks of the public functions of all modules, see bench.h for the method
+//usage: ./a.out [-f csv|json] [-r reps] [filter] > results
+//compare two runs on the same box with a diff or a spreadsheet, results are ticks per operation
+
+#include "bench.h"
+
+#include "bufops.h"
+#include "paged_op.h"
+#include "hexload.h"
+
+//output of print.h and printx.h goes to a sink, the cost of the formatting is measured
+#define PRINT_PREFIX bench_
+static void bench_print_impl(const char*msg){bench_sink+=msg[0];}
+#include "print.h"
+
+#define PRINT_PREFIX bbuf_
+#define PRINT_BUFFER_SIZE 128
+static void bbuf_print_impl(const char*msg){bench_sink+=msg[0];}
+#include "print.h"
+
+#define PRINT_PREFIX bring_
+#define PRINT_BUFFER_SIZE 128
+#define PRINT_RING_SLOTS 64
+static void bring_print_impl(const char*msg){bench_sink+=msg[0];}
+#include "print.h"
+
+#define PRINT_PREFIX bbin_
+#define PRINT_BINARY
+static void bbin_print_bin_impl(const uint8_t*rec, unsigned int size){bench_sink+=rec[0]+size;}
+#include "print.h"
+
+//binary records captured for print_decode
+#define BIN_CAPTURE_SIZE (1<<16)
+static uint8_t bin_capture[BIN_CAPTURE_SIZE];
+static size_t bin_capture_len;
+#define PRINT_PREFIX bcap_
+#define PRINT_BINARY
+static void bcap_print_bin_impl(const uint8_t*rec, unsigned int size){
+    if(bin_capture_len+size>BIN_CAPTURE_SIZE) return;
+    memcpy(bin_capture+bin_capture_len,rec,size);
+    bin_capture_len+=size;
+}
+#include "print.h"
+#include "print_decode.h"
+
+static int bench_printf(const char *fmt, ...){
+    char text[256];
+    va_list ap;
+    va_start(ap,fmt);
+    const int n = vsnprintf(text,sizeof(text),fmt,ap);
+    va_end(ap);
+    bench_sink+=text[0];
+    return n;
+}
+#define printx_printf bench_printf
+#define printx_write(buf,len) (bench_sink+=(buf)[0]+(len))
+#define PRINTX_HAS_PTHREAD
+#include "printx.h"
+
+#define MAX_SIZE (1<<16)
+static uint8_t src[MAX_SIZE];
+static uint8_t dst[MAX_SIZE];
+static char text[4*MAX_SIZE];
+static size_t text_len;
+
+//printx64_dump_buf_mt formats chunks of PRINTX_DUMP_CHUNK_LINES lines in parallel and falls back
+//to printx64_dump_buf for a single chunk: it is measured on several chunks of 64 bytes lines
+#define DUMP_MT_SIZE (4*64*PRINTX_DUMP_CHUNK_LINES)
+static uint8_t dump_mt_src[DUMP_MT_SIZE];
+
+#define N_VALUES 1024
+static uint64_t values[N_VALUES];
+static uint32_t offsets[N_VALUES];
+static uint32_t sizes[N_VALUES];
+
+//parameters of the current case
+typedef struct bench_case_struct {
+    size_t size;        //bytes, bits for the bit shifts
+    size_t shift;
+    unsigned int digits;
+    uint32_t page_size;
+    uint32_t granularity;
+    size_t bytes_per_word;
+    unsigned int threads;
+} bench_case_t;
+
+//bufops
+static void run_shl(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_shl(dst,src,c->size,c->shift,0);BENCH_CLOBBER();}
+static void run_shr(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_shr(dst,src,c->size,c->shift,0);BENCH_CLOBBER();}
+static void run_shlbits(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_shlbits(dst,src,c->size,c->shift,0);BENCH_CLOBBER();}
+static void run_shrbits(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_shrbits(dst,src,c->size,c->shift,0);BENCH_CLOBBER();}
+static void run_shl_be(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_shl_be(dst,src,c->size,c->shift,0);BENCH_CLOBBER();}
+static void run_shr_be(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_shr_be(dst,src,c->size,c->shift,0);BENCH_CLOBBER();}
+static void run_shlbits_be(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_shlbits_be(dst,src,c->size,c->shift,0);BENCH_CLOBBER();}
+static void run_shrbits_be(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_shrbits_be(dst,src,c->size,c->shift,0);BENCH_CLOBBER();}
+static void run_reverse(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_reverse(dst,c->size);BENCH_CLOBBER();}
+static void run_swap16(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_swap16(dst,c->size/2);BENCH_CLOBBER();}
+static void run_swap32(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_swap32(dst,c->size/4);BENCH_CLOBBER();}
+static void run_swap64(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bufops_swap64(dst,c->size/8);BENCH_CLOBBER();}
+
+//paged_op, N_VALUES random ranges per call
+static void run_paged_op32_compute(void *ctx){
+    bench_case_t *c=(bench_case_t*)ctx;
+    paged_op32_t op;
+    for(unsigned int i=0;i<N_VALUES;i++){
+        paged_op32_compute(&op,offsets[i],sizes[i],c->page_size,c->granularity);
+        bench_sink+=op.first_size;
+    }
+}
+
+//print, N_VALUES numbers per call
+static void run_print_uint_as_dec(void *ctx){bench_case_t *c=(bench_case_t*)ctx;for(unsigned int i=0;i<N_VALUES;i++) bench_print_uint_as_dec(values[i]>>(64-c->shift),c->digits);}
+static void run_print_uint_as_hex(void *ctx){bench_case_t *c=(bench_case_t*)ctx;for(unsigned int i=0;i<N_VALUES;i++) bench_print_uint_as_hex(values[i],c->digits);}
+static void run_println32x(void *ctx){(void)ctx;for(unsigned int i=0;i<N_VALUES;i++) bench_println32x("x=0x",values[i]);}
+static void run_println32d(void *ctx){(void)ctx;for(unsigned int i=0;i<N_VALUES;i++) bench_println32d("x=",values[i]);}
+static void run_println64x(void *ctx){(void)ctx;for(unsigned int i=0;i<N_VALUES;i++) bench_println64x("x=0x",values[i]);}
+static void run_print_bytes(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bench_println_bytes("b=",src,c->size);}
+static void run_print_array32x_0xln(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bench_print_array32x_0xln(src,c->size/4);}
+static void run_buffered_println32x(void *ctx){(void)ctx;for(unsigned int i=0;i<N_VALUES;i++) bbuf_println32x("x=0x",values[i]);}
+static void run_ring_println32x(void *ctx){
+    (void)ctx;
+    for(unsigned int i=0;i<N_VALUES;i++){
+        bring_println32x("x=0x",values[i]);
+        if(0==(i%32)) bring_print_ring_drain();
+    }
+    bring_print_ring_drain();
+}
+static void run_binary_println32x(void *ctx){(void)ctx;for(unsigned int i=0;i<N_VALUES;i++) bbin_println32x("x=0x",values[i]);}
+static void run_print_bytes_0x(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bench_println_bytes_0x("b=",src,c->size);}
+static void run_ring_write(void *ctx){
+    (void)ctx;
+    for(unsigned int i=0;i<N_VALUES;i++){
+        bring_print_ring_write("x=0x01234567\n");
+        if(0==(i%32)) bring_print_ring_drain();
+    }
+    bring_print_ring_drain();
+}
+//host side: decode the records of N_VALUES bcap_println32x calls
+static print_decode_t decoder;
+static void decode_out(void *ctx, const char *text, size_t len){(void)ctx;bench_sink+=text[0]+len;}
+static void run_print_decode(void *ctx){
+    (void)ctx;
+    size_t consumed;
+    bench_sink+=print_decode(&decoder,bin_capture,bin_capture_len,&consumed);
+}
+
+//printx
+static void run_printx_bytes(void *ctx){bench_case_t *c=(bench_case_t*)ctx;printx_bytes("b=",src,c->size,"\n");}
+static void run_printx_diff_bytes_sep(void *ctx){bench_case_t *c=(bench_case_t*)ctx;printx_diff_bytes_sep("d=",src,c->size,"\n"," ");}
+static void run_printx_128(void *ctx){(void)ctx;for(unsigned int i=0;i<N_VALUES;i++) printx_128("v=",src+16*i,"\n");}
+static void run_printx32_dump_buf(void *ctx){bench_case_t *c=(bench_case_t*)ctx;printx32_dump_buf("",src,c->size,0,c->bytes_per_word,64/c->bytes_per_word);}
+static void run_printx64_dump_buf(void *ctx){bench_case_t *c=(bench_case_t*)ctx;printx64_dump_buf("",src,c->size,0,c->bytes_per_word,64/c->bytes_per_word);}
+static void run_printx64_dump_buf_big(void *ctx){bench_case_t *c=(bench_case_t*)ctx;printx64_dump_buf("",dump_mt_src,c->size,0,c->bytes_per_word,64/c->bytes_per_word);}
+static void run_printx64_dump_buf_mt(void *ctx){bench_case_t *c=(bench_case_t*)ctx;printx64_dump_buf_mt("",dump_mt_src,c->size,0,c->bytes_per_word,64/c->bytes_per_word,c->threads);}
+static void run_printx_hex_encode(void *ctx){bench_case_t *c=(bench_case_t*)ctx;printx_hex_encode(text,src,c->size);BENCH_CLOBBER();}
+static void run_printx_hex_decode(void *ctx){bench_case_t *c=(bench_case_t*)ctx;size_t bad_pos;printx_hex_decode(dst,text,2*c->size,&bad_pos);BENCH_CLOBBER();}
+static void run_printx_hexstr_to_bytes(void *ctx){bench_case_t *c=(bench_case_t*)ctx;printx_hexstr_to_bytes(dst,c->size,text);BENCH_CLOBBER();}
+static void run_printx_bytes_to_hexstr(void *ctx){bench_case_t *c=(bench_case_t*)ctx;printx_bytes_to_hexstr(text,src,c->size);BENCH_CLOBBER();}
+//works in place, text holds plain hex digits so the cleanup leaves it unchanged from one call to the next
+static void run_printx_user_hexstr_to_bytes(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bench_sink+=printx_user_hexstr_to_bytes(dst,c->size,text,2*c->size+1);BENCH_CLOBBER();}
+static void run_printx_hexparse(void *ctx){
+    bench_case_t *c=(bench_case_t*)ctx;
+    printx_hexparse_t p;
+    printx_hexparse_init(&p,dst,c->size);
+    printx_hexparse_feed(&p,text,text_len);
+    bench_sink+=printx_hexparse_finish(&p);
+}
+static void run_printx_diff_next(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bench_sink+=printx_diff_next(src,dst,c->size,0);}
+static void run_printx32_diff_buf32(void *ctx){bench_case_t *c=(bench_case_t*)ctx;bench_sink+=printx32_diff_buf32("",src,dst,c->size,0,2);}
+
+//hexload: Intel HEX text in text, 16 bytes per record
+static uint8_t hexload_mem[HEXLOAD_MEM_SIZE(4096,HEXLOAD_MAX_PAGES)];
+static int hexload_sink_write(void *ctx, uint32_t addr, const uint8_t *data, uint32_t size){
+    (void)ctx;
+    bench_sink+=addr+data[0]+size;
+    return 0;
+}
+static void run_hexload_feed(void *ctx){
+    bench_case_t *c=(bench_case_t*)ctx;
+    hexload_t h;
+    hexload_init(&h,hexload_mem,HEXLOAD_MAX_PAGES,c->page_size,c->granularity,0xFF,hexload_sink_write,0);
+    hexload_feed(&h,text,text_len);
+    bench_sink+=hexload_finish(&h);
+}
+static size_t make_intel_hex(size_t size){
+    size_t len = 0;
+    for(size_t addr=0;addr<size;addr+=16){
+        uint8_t r[4+16];
+        r[0]=16; r[1]=addr>>8; r[2]=addr; r[3]=0;
+        memcpy(r+4,src+addr,16);
+        uint8_t sum=0;
+        for(unsigned int i=0;i<sizeof(r);i++) sum+=r[i];
+        text[len++] = ':';
+        len += printx_hex_encode(text+len,r,sizeof(r));
+        const uint8_t checksum = -sum;
+        len += printx_hex_encode(text+len,&checksum,1);
+        text[len++] = '\n';
+    }
+    len += sprintf(text+len,":00000001FF\n");
+    return len;
+}
+
+static void usage(const char *name){
+    fprintf(stderr,"usage: %s [-f csv|json] [-r reps] [filter]\n",name);
+}
+
+int main(int argc, char *argv[]){
+    bench_format_t format = BENCH_CSV;
+    unsigned int reps = BENCH_REPS;
+    const char *filter = 0;
+    for(int i=1;i<argc;i++){
+        if(0==strcmp(argv[i],"-f") && i+1<argc){
+            i++;
+            if(0==strcmp(argv[i],"csv")) format = BENCH_CSV;
+            else if(0==strcmp(argv[i],"json")) format = BENCH_JSON;
+            else {usage(argv[0]);return 1;}
+        } else if(0==strcmp(argv[i],"-r") && i+1<argc){
+            reps = atoi(argv[++i]);
+        } else if((0==filter) && ('-'!=argv[i][0])){
+            filter = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    uint64_t x=0x0123456789ABCDEFull;
+    for(size_t i=0;i<MAX_SIZE;i++){
+        x^=x<<13;x^=x>>7;x^=x<<17;
+        src[i] = x;
+    }
+    for(unsigned int i=0;i<N_VALUES;i++){
+        x^=x<<13;x^=x>>7;x^=x<<17;
+        values[i] = x;
+        offsets[i] = x%MAX_SIZE;
+        sizes[i] = (x>>32)%(MAX_SIZE-offsets[i]+1);
+    }
+    bench_t b;
+    bench_init(&b,stdout,format,filter,reps);
+    char params[128];
+    bench_case_t c;
+    memset(&c,0,sizeof(c));
+
+    const size_t byte_sizes[] = {16,256,4096,MAX_SIZE};
+    for(unsigned int s=0;s<sizeof(byte_sizes)/sizeof(byte_sizes[0]);s++){
+        c.size = byte_sizes[s];
+        c.shift = 3;
+        sprintf(params,"size=%zu shift=%zu",c.size,c.shift);
+        bench_run(&b,"bufops_shl",params,1,c.size,run_shl,&c);
+        bench_run(&b,"bufops_shr",params,1,c.size,run_shr,&c);
+        bench_run(&b,"bufops_shl_be",params,1,c.size,run_shl_be,&c);
+        bench_run(&b,"bufops_shr_be",params,1,c.size,run_shr_be,&c);
+        sprintf(params,"size=%zu",c.size);
+        bench_run(&b,"bufops_reverse",params,1,c.size,run_reverse,&c);
+        bench_run(&b,"bufops_swap16",params,1,c.size,run_swap16,&c);
+        bench_run(&b,"bufops_swap32",params,1,c.size,run_swap32,&c);
+        bench_run(&b,"bufops_swap64",params,1,c.size,run_swap64,&c);
+        const size_t bit_shifts[] = {1,13,64};
+        for(unsigned int k=0;k<sizeof(bit_shifts)/sizeof(bit_shifts[0]);k++){
+            c.size = 8*byte_sizes[s]-3;//not a whole number of bytes
+            c.shift = bit_shifts[k];
+            sprintf(params,"size=%zu shift=%zu",c.size,c.shift);
+            bench_run(&b,"bufops_shlbits",params,1,byte_sizes[s],run_shlbits,&c);
+            bench_run(&b,"bufops_shrbits",params,1,byte_sizes[s],run_shrbits,&c);
+            bench_run(&b,"bufops_shlbits_be",params,1,byte_sizes[s],run_shlbits_be,&c);
+            bench_run(&b,"bufops_shrbits_be",params,1,byte_sizes[s],run_shrbits_be,&c);
+        }
+    }
+
+    const uint32_t geometries[][2] = {{4096,4},{256,8},{60,12},{16,1}};
+    for(unsigned int g=0;g<sizeof(geometries)/sizeof(geometries[0]);g++){
+        c.page_size = geometries[g][0];
+        c.granularity = geometries[g][1];
+        sprintf(params,"page_size=%u granularity=%u",c.page_size,c.granularity);
+        bench_run(&b,"paged_op32_compute",params,N_VALUES,0,run_paged_op32_compute,&c);
+    }
+
+    const unsigned int dec_digits[][2] = {{3,8},{5,16},{10,32},{20,64}};//digits, bits of the values
+    for(unsigned int d=0;d<sizeof(dec_digits)/sizeof(dec_digits[0]);d++){
+        c.digits = dec_digits[d][0];
+        c.shift = dec_digits[d][1];
+        sprintf(params,"digits=%u bits=%zu",c.digits,c.shift);
+        bench_run(&b,"print_uint_as_dec",params,N_VALUES,0,run_print_uint_as_dec,&c);
+    }
+    const unsigned int hex_digits[] = {2,4,8,16};
+    for(unsigned int d=0;d<sizeof(hex_digits)/sizeof(hex_digits[0]);d++){
+        c.digits = hex_digits[d];
+        sprintf(params,"digits=%u",c.digits);
+        bench_run(&b,"print_uint_as_hex",params,N_VALUES,0,run_print_uint_as_hex,&c);
+    }
+    bench_run(&b,"println32x","",N_VALUES,0,run_println32x,&c);
+    bench_run(&b,"println32d","",N_VALUES,0,run_println32d,&c);
+    bench_run(&b,"println64x","",N_VALUES,0,run_println64x,&c);
+    bench_run(&b,"println32x","buffer=128",N_VALUES,0,run_buffered_println32x,&c);
+    bench_run(&b,"println32x","buffer=128 ring=64",N_VALUES,0,run_ring_println32x,&c);
+    bench_run(&b,"println32x","binary",N_VALUES,0,run_binary_println32x,&c);
+    bench_run(&b,"print_ring_write","buffer=128 ring=64",N_VALUES,0,run_ring_write,&c);
+    for(unsigned int i=0;i<N_VALUES;i++) bcap_println32x("x=0x",values[i]);
+    {
+        size_t consumed;
+        if(print_decode_init(&decoder,decode_out,0) || print_decode(&decoder,bin_capture,bin_capture_len,&consumed) || (consumed!=bin_capture_len)){
+            fprintf(stderr,"print_decode failed on the benchmark records\n");
+            return 1;
+        }
+    }
+    bench_run(&b,"print_decode","println32x",N_VALUES,bin_capture_len,run_print_decode,&c);
+    print_decode_free(&decoder);
+    bench_run(&b,"printx_128","",N_VALUES,0,run_printx_128,&c);
+    const size_t print_sizes[] = {16,256};
+    for(unsigned int s=0;s<sizeof(print_sizes)/sizeof(print_sizes[0]);s++){
+        c.size = print_sizes[s];
+        sprintf(params,"size=%zu",c.size);
+        bench_run(&b,"println_bytes",params,1,c.size,run_print_bytes,&c);
+        bench_run(&b,"print_array32x_0xln",params,1,c.size,run_print_array32x_0xln,&c);
+        bench_run(&b,"print_bytes_0x",params,1,c.size,run_print_bytes_0x,&c);
+        bench_run(&b,"printx_bytes",params,1,c.size,run_printx_bytes,&c);
+        bench_run(&b,"printx_diff_bytes_sep",params,1,c.size,run_printx_diff_bytes_sep,&c);
+    }
+
+    for(size_t i=0;i<DUMP_MT_SIZE;i++) dump_mt_src[i] = src[i%MAX_SIZE]^(i>>16);
+    c.size = DUMP_MT_SIZE;
+    c.bytes_per_word = 4;
+    sprintf(params,"size=%u bytes_per_word=4",DUMP_MT_SIZE);
+    bench_run(&b,"printx64_dump_buf",params,1,c.size,run_printx64_dump_buf_big,&c);
+    for(c.threads=2;c.threads<=4;c.threads*=2){
+        sprintf(params,"size=%u bytes_per_word=4 threads=%u chunk_lines=%u",DUMP_MT_SIZE,c.threads,PRINTX_DUMP_CHUNK_LINES);
+        bench_run(&b,"printx64_dump_buf_mt",params,1,c.size,run_printx64_dump_buf_mt,&c);
+    }
+
+    for(unsigned int s=1;s<sizeof(byte_sizes)/sizeof(byte_sizes[0]);s++){
+        c.size = byte_sizes[s];
+        for(c.bytes_per_word=4;c.bytes_per_word<=8;c.bytes_per_word*=2){
+            sprintf(params,"size=%zu bytes_per_word=%zu",c.size,c.bytes_per_word);
+            bench_run(&b,"printx32_dump_buf",params,1,c.size,run_printx32_dump_buf,&c);
+            bench_run(&b,"printx64_dump_buf",params,1,c.size,run_printx64_dump_buf,&c);
+        }
+        sprintf(params,"size=%zu",c.size);
+        bench_run(&b,"printx_hex_encode",params,1,c.size,run_printx_hex_encode,&c);
+        printx_hex_encode(text,src,c.size);
+        text[2*c.size] = 0;
+        bench_run(&b,"printx_hex_decode",params,1,c.size,run_printx_hex_decode,&c);
+        bench_run(&b,"printx_hexstr_to_bytes",params,1,c.size,run_printx_hexstr_to_bytes,&c);
+        bench_run(&b,"printx_user_hexstr_to_bytes",params,1,c.size,run_printx_user_hexstr_to_bytes,&c);
+        bench_run(&b,"printx_bytes_to_hexstr",params,1,c.size,run_printx_bytes_to_hexstr,&c);
+        //one line of 32 bytes per test vector
+        text_len = 0;
+        for(size_t i=0;i<c.size;i+=32){
+            text_len += printx_hex_encode(text+text_len,src+i,32);
+            text[text_len++] = '\n';
+        }
+        bench_run(&b,"printx_hexparse_feed",params,1,c.size,run_printx_hexparse,&c);
+        memcpy(dst,src,c.size);
+        for(unsigned int i=0;i<4;i++) dst[c.size/2+(i*7919)%(c.size/2)] ^= 0x80;//identical first half
+        bench_run(&b,"printx_diff_next",params,1,c.size,run_printx_diff_next,&c);
+        bench_run(&b,"printx32_diff_buf32",params,1,c.size,run_printx32_diff_buf32,&c);
+    }
+
+    text_len = make_intel_hex(MAX_SIZE);
+    {
+        hexload_t h;
+        hexload_init(&h,hexload_mem,HEXLOAD_MAX_PAGES,4096,4,0xFF,hexload_sink_write,0);
+        if(hexload_feed(&h,text,text_len) || hexload_finish(&h)){
+            fprintf(stderr,"hexload_feed failed on the benchmark image\n");
+            return 1;
+        }
+    }
+    const uint32_t hexload_geometries[][2] = {{4096,4},{256,8}};
+    for(unsigned int g=0;g<sizeof(hexload_geometries)/sizeof(hexload_geometries[0]);g++){
+        c.page_size = hexload_geometries[g][0];
+        c.granularity = hexload_geometries[g][1];
+        sprintf(params,"size=%u page_size=%u granularity=%u",MAX_SIZE,c.page_size,c.granularity);
+        bench_run(&b,"hexload_feed",params,1,MAX_SIZE,run_hexload_feed,&c);
+    }
+
+    bench_finish(&b);
+    (void)printx_remove_unused_warnings;
+    return 0;
+}
@@ -3,6 +3,12 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+
+//SSSE3 versions of bufops_reverse/bufops_swap* are used when the compiler targets it
+#if !defined(BUFOPS_NO_SIMD) && defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
 
 /**
  * shift a buffer left with byte granularity (little endian)
@@ -152,6 +158,285 @@ static void bufops_shrbits(void*const dst,const void*const src,size_t size, size
         dst8[byte_size-1] |= last & last_mask;
     }
 }
+
+//byte swaps, shift based when the compiler has no builtin
+static uint32_t bufops_bswap32(uint32_t v){
+#if defined(__GNUC__)
+    return __builtin_bswap32(v);
+#else
+    return (v>>24) | ((v>>8) & 0x0000FF00) | ((v<<8) & 0x00FF0000) | (v<<24);
+#endif
+}
+static uint64_t bufops_bswap64(uint64_t v){
+#if defined(__GNUC__)
+    return __builtin_bswap64(v);
+#else
+    return ((uint64_t)bufops_bswap32((uint32_t)v)<<32) | bufops_bswap32((uint32_t)(v>>32));
+#endif
+}
+//big endian 64 bit load/store, byte by byte when the byte order is not known at compile time
+static uint64_t bufops_load_be64(const uint8_t*const p){
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    uint64_t v;
+    memcpy(&v,p,8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = bufops_bswap64(v);
+#endif
+#else
+    uint64_t v=0;
+    for(unsigned int i=0;i<8;i++) v = (v<<8) | p[i];
+#endif
+    return v;
+}
+static void bufops_store_be64(uint8_t*const p, uint64_t v){
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = bufops_bswap64(v);
+#endif
+    memcpy(p,&v,8);
+#else
+    for(unsigned int i=0;i<8;i++) p[i] = (uint8_t)(v>>(56-8*i));
+#endif
+}
+/**
+ * reverse the byte order of a buffer in place (little endian <-> big endian)
+ *
+ * @param   buf         buffer
+ * @param   byte_size   length in bytes of buf
+*/
+static void bufops_reverse(void*const buf,size_t byte_size){
+    uint8_t*lo=(uint8_t*)buf;
+    uint8_t*hi=lo+byte_size;
+#if !defined(BUFOPS_NO_SIMD) && defined(__SSSE3__)
+    const __m128i rev = _mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+    while(hi-lo>=32){
+        const __m128i a = _mm_loadu_si128((const __m128i*)lo);
+        const __m128i b = _mm_loadu_si128((const __m128i*)(hi-16));
+        _mm_storeu_si128((__m128i*)lo,_mm_shuffle_epi8(b,rev));
+        _mm_storeu_si128((__m128i*)(hi-16),_mm_shuffle_epi8(a,rev));
+        lo+=16;
+        hi-=16;
+    }
+#endif
+    while(hi-lo>=16){
+        uint64_t a,b;
+        memcpy(&a,lo,8);
+        memcpy(&b,hi-8,8);
+        a = bufops_bswap64(a);
+        b = bufops_bswap64(b);
+        memcpy(lo,&b,8);
+        memcpy(hi-8,&a,8);
+        lo+=8;
+        hi-=8;
+    }
+    while(hi-lo>=2){
+        const uint8_t t = *lo;
+        *lo++ = *--hi;
+        *hi = t;
+    }
+}
+/**
+ * swap the bytes of each 16 bit word of a buffer in place
+ *
+ * @param   buf         buffer
+ * @param   n_words     number of 16 bit words in buf
+*/
+static void bufops_swap16(void*const buf,size_t n_words){
+    uint8_t*const buf8=(uint8_t*)buf;
+    const size_t byte_size = 2*n_words;
+    size_t i=0;
+#if !defined(BUFOPS_NO_SIMD) && defined(__SSSE3__)
+    const __m128i swap = _mm_set_epi8(14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1);
+    for(;i+16<=byte_size;i+=16) _mm_storeu_si128((__m128i*)(buf8+i),_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(buf8+i)),swap));
+#endif
+    for(;i+8<=byte_size;i+=8){
+        uint64_t v;
+        memcpy(&v,buf8+i,8);
+        v = ((v>>8) & 0x00FF00FF00FF00FFull) | ((v<<8) & 0xFF00FF00FF00FF00ull);
+        memcpy(buf8+i,&v,8);
+    }
+    for(;i<byte_size;i+=2){
+        const uint8_t t = buf8[i];
+        buf8[i] = buf8[i+1];
+        buf8[i+1] = t;
+    }
+}
+/**
+ * swap the bytes of each 32 bit word of a buffer in place
+ *
+ * @param   buf         buffer
+ * @param   n_words     number of 32 bit words in buf
+*/
+static void bufops_swap32(void*const buf,size_t n_words){
+    uint8_t*const buf8=(uint8_t*)buf;
+    const size_t byte_size = 4*n_words;
+    size_t i=0;
+#if !defined(BUFOPS_NO_SIMD) && defined(__SSSE3__)
+    const __m128i swap = _mm_set_epi8(12,13,14,15,8,9,10,11,4,5,6,7,0,1,2,3);
+    for(;i+16<=byte_size;i+=16) _mm_storeu_si128((__m128i*)(buf8+i),_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(buf8+i)),swap));
+#endif
+    for(;i+8<=byte_size;i+=8){
+        uint64_t v;
+        memcpy(&v,buf8+i,8);
+        v = bufops_bswap64(v);
+        v = (v>>32) | (v<<32);
+        memcpy(buf8+i,&v,8);
+    }
+    for(;i<byte_size;i+=4){
+        uint32_t v;
+        memcpy(&v,buf8+i,4);
+        v = bufops_bswap32(v);
+        memcpy(buf8+i,&v,4);
+    }
+}
+/**
+ * swap the bytes of each 64 bit word of a buffer in place
+ *
+ * @param   buf         buffer
+ * @param   n_words     number of 64 bit words in buf
+*/
+static void bufops_swap64(void*const buf,size_t n_words){
+    uint8_t*const buf8=(uint8_t*)buf;
+    const size_t byte_size = 8*n_words;
+    size_t i=0;
+#if !defined(BUFOPS_NO_SIMD) && defined(__SSSE3__)
+    const __m128i swap = _mm_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7);
+    for(;i+16<=byte_size;i+=16) _mm_storeu_si128((__m128i*)(buf8+i),_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(buf8+i)),swap));
+#endif
+    for(;i<byte_size;i+=8){
+        uint64_t v;
+        memcpy(&v,buf8+i,8);
+        v = bufops_bswap64(v);
+        memcpy(buf8+i,&v,8);
+    }
+}
+
+/**
+ * shift a buffer left with byte granularity (big endian: byte 0 is the MSB)
+ *
+ * @param   dst         destination buffer, can be equal to src
+ * @param   src         source buffer
+ * @param   byte_size   length in bytes of src/dst
+ * @param   byte_shift  shift amount in bytes
+ * @param   fill8       fill value for the LSBs
+ *
+ * byte_shift is allowed to be larger than byte_size, it behaves like they are equal
+*/
+static void bufops_shl_be(void*const dst,const void*const src,size_t byte_size, size_t byte_shift, uint8_t fill8){
+    if(0==byte_size) return;
+    if(byte_shift>byte_size) byte_shift=byte_size;
+    uint8_t*const dst8=(uint8_t*)dst;
+    const uint8_t*const src8=(const uint8_t*const)src;
+    memmove(dst8,src8+byte_shift,byte_size-byte_shift);
+    memset(dst8+byte_size-byte_shift,fill8,byte_shift);
+}
+/**
+ * shift a buffer left with bit granularity (big endian: byte 0 is the MSB)
+ *
+ * @param   dst         destination buffer, can be equal to src
+ * @param   src         source buffer
+ * @param   size        length in bits of src/dst
+ * @param   shift       shift amount in bits
+ * @param   fill        fill value for the LSBs
+ *
+ * the value is held in the size LSBs of the buffer, the unused MSBs of byte 0 are preserved
+ * shift is allowed to be larger than size, it behaves like they are equal
+*/
+static void bufops_shlbits_be(void*const dst,const void*const src,size_t size, size_t shift, bool fill){
+    if(0==size) return;
+    const uint8_t fill8 = fill ? 0xFF : 0x00;
+    if(shift>size) shift=size;
+    uint8_t*const dst8=(uint8_t*)dst;
+    const uint8_t*const src8=(const uint8_t*const)src;
+    const size_t byte_size = (size+7)/8;
+    const unsigned int bshift = shift%8;
+    const size_t lsb = shift/8;
+    const uint8_t first = src8[0];
+    if(0==bshift){
+        bufops_shl_be(dst,src,byte_size,lsb,fill8);
+    } else {
+        //dst[i] gets bits from src[i+lsb] and src[i+lsb+1], in increasing order so dst can be equal to src
+        size_t i=0;
+        for(;i+lsb+9<=byte_size;i+=8){
+            const uint64_t v = bufops_load_be64(src8+i+lsb);
+            bufops_store_be64(dst8+i,(v<<bshift)|(src8[i+lsb+8]>>(8-bshift)));
+        }
+        for(;i<byte_size;i++){
+            const uint8_t hi = i+lsb   < byte_size ? src8[i+lsb]   : fill8;
+            const uint8_t lo = i+lsb+1 < byte_size ? src8[i+lsb+1] : fill8;
+            dst8[i] = (uint8_t)((hi<<bshift)|(lo>>(8-bshift)));
+        }
+    }
+    if(size%8){
+        const uint8_t first_mask = 0xFF<<(size % 8);
+        dst8[0] &= ~first_mask;
+        dst8[0] |= first & first_mask;
+    }
+}
+/**
+ * shift a buffer right with byte granularity (big endian: byte 0 is the MSB)
+ *
+ * @param   dst         destination buffer, can be equal to src
+ * @param   src         source buffer
+ * @param   byte_size   length in bytes of src/dst
+ * @param   byte_shift  shift amount in bytes
+ * @param   fill8       fill value for the MSBs
+ *
+ * byte_shift is allowed to be larger than byte_size, it behaves like they are equal
+*/
+static void bufops_shr_be(void*const dst,const void*const src,size_t byte_size, size_t byte_shift, uint8_t fill8){
+    if(0==byte_size) return;
+    if(byte_shift>byte_size) byte_shift=byte_size;
+    uint8_t*const dst8=(uint8_t*)dst;
+    const uint8_t*const src8=(const uint8_t*const)src;
+    memmove(dst8+byte_shift,src8,byte_size-byte_shift);
+    memset(dst8,fill8,byte_shift);
+}
+/**
+ * shift a buffer right with bit granularity (big endian: byte 0 is the MSB)
+ *
+ * @param   dst         destination buffer, can be equal to src
+ * @param   src         source buffer
+ * @param   size        length in bits of src/dst
+ * @param   shift       shift amount in bits
+ * @param   fill        fill value for the MSBs
+ *
+ * the value is held in the size LSBs of the buffer, the unused MSBs of byte 0 are preserved
+ * shift is allowed to be larger than size, it behaves like they are equal
+*/
+static void bufops_shrbits_be(void*const dst,const void*const src,size_t size, size_t shift, bool fill){
+    if(0==size) return;
+    const uint8_t fill8 = fill ? 0xFF : 0x00;
+    if(shift>size) shift=size;
+    uint8_t*const dst8=(uint8_t*)dst;
+    const uint8_t*const src8=(const uint8_t*const)src;
+    const size_t byte_size = (size+7)/8;
+    const unsigned int bshift = shift%8;
+    const size_t lsb = shift/8;
+    const uint8_t first = src8[0];
+    const uint8_t first_mask = size%8 ? 0xFF<<(size % 8) : 0;
+    //value of byte 0 with the unused MSBs replaced by fill
+    const uint8_t first_value = (first & ~first_mask) | (fill8 & first_mask);
+    if((0==bshift) && (0==first_mask)){
+        bufops_shr_be(dst,src,byte_size,lsb,fill8);
+    } else {
+        //dst[i] gets bits from src[i-lsb] and src[i-lsb-1], in decreasing order so dst can be equal to src
+        size_t i=byte_size;
+        for(;i>=lsb+10;i-=8){//src[i-lsb-9] is not byte 0
+            const uint64_t v = bufops_load_be64(src8+i-lsb-8);
+            bufops_store_be64(dst8+i-8,(v>>bshift)|((uint64_t)src8[i-lsb-9]<<(63-bshift)<<1));
+        }
+        while(i--){
+            const uint8_t lo = i>=lsb   ? (i==lsb   ? first_value : src8[i-lsb])   : fill8;
+            const uint8_t hi = i>=lsb+1 ? (i==lsb+1 ? first_value : src8[i-lsb-1]) : fill8;
+            dst8[i] = (uint8_t)((lo>>bshift)|(hi<<(8-bshift)));
+        }
+    }
+    if(size%8){
+        dst8[0] &= ~first_mask;
+        dst8[0] |= first & first_mask;
+    }
+}
 #ifdef BUFOPS_INCLUDE_TESTS
 #include <assert.h>
 void bufops_bufshl_test(void){
@@ -258,6 +543,158 @@ void bufops_bufshr_test(void){
         }
     }
 }
+void bufops_bufshl_be_test(void){
+    //the buffer is the tail of the big endian representation of a 64 bit value:
+    //the value of size bits is held in its (size+7)/8 LSBs, expected results are the same as the little endian tests
+    const uint64_t tv[] = {
+        0x0000000000000000,
+        0x0000000000000001,
+        0x8000000000000000,
+        0x8000000000000001,
+        0x5555555555555555,
+        0xAAAAAAAAAAAAAAAA,
+        0xFFFFFFFFFFFFFFFF,
+        0xFFFFFFFFFFFFFFFE,
+        0x7FFFFFFFFFFFFFFF,
+        0x7FFFFFFFFFFFFFFE,
+        0x0123456789ABCDEF,
+        0x257F4883E5289CD4,
+        0x473E039541FD0E85,
+        0x3D69139463520062,
+        0xE3B4B05FB914863D,
+    };
+    for(unsigned int i=0;i<sizeof(tv)/sizeof(uint64_t);i++){
+        const uint64_t src = tv[i];
+        uint8_t src_be[8];
+        bufops_store_be64(src_be,src);
+        for(unsigned int size=0;size<64;size++){
+            const uint64_t mask = size ? 0xFFFFFFFFFFFFFFFF >> (64-size) : 0;
+            const uint64_t imask = ~mask;
+            const size_t byte_size = (size+7)/8;
+            for(unsigned int shift=0;shift<=(size+1);shift++){
+                for(uint64_t fill=0;fill<2;fill++){
+                    uint8_t result_be[8];
+                    bufops_store_be64(result_be,src);
+                    bufops_shlbits_be(result_be+8-byte_size,result_be+8-byte_size,size,shift,fill);
+                    const unsigned int tb_shift = shift>size ? size : shift;
+                    const uint64_t pad = fill ? (fill<<tb_shift)-1 : 0;
+                    const uint64_t expected = ((src<<tb_shift) & mask) | (src & imask) | pad;
+                    assert(expected==bufops_load_be64(result_be));
+                    if(size){
+                        const uint64_t dst_init[] = {src & imask, (src & imask) | (0xFFFFFFFFFFFFFFFF & mask), (src & imask) | (~expected & mask)};
+                        for(unsigned int k=0;k<sizeof(dst_init)/sizeof(uint64_t);k++){
+                            bufops_store_be64(result_be,dst_init[k]);
+                            bufops_shlbits_be(result_be+8-byte_size,src_be+8-byte_size,size,shift,fill);
+                            assert(expected==bufops_load_be64(result_be));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+void bufops_bufshr_be_test(void){
+    //the buffer is the tail of the big endian representation of a 64 bit value:
+    //the value of size bits is held in its (size+7)/8 LSBs, expected results are the same as the little endian tests
+    const uint64_t tv[] = {
+        0x0000000000000000,
+        0x0000000000000001,
+        0x8000000000000000,
+        0x8000000000000001,
+        0x5555555555555555,
+        0xAAAAAAAAAAAAAAAA,
+        0xFFFFFFFFFFFFFFFF,
+        0xFFFFFFFFFFFFFFFE,
+        0x7FFFFFFFFFFFFFFF,
+        0x7FFFFFFFFFFFFFFE,
+        0x0123456789ABCDEF,
+        0x257F4883E5289CD4,
+        0x473E039541FD0E85,
+        0x3D69139463520062,
+        0xE3B4B05FB914863D,
+    };
+    for(unsigned int i=0;i<sizeof(tv)/sizeof(uint64_t);i++){
+        const uint64_t src = tv[i];
+        uint8_t src_be[8];
+        bufops_store_be64(src_be,src);
+        for(unsigned int size=0;size<64;size++){
+            const uint64_t mask = size ? 0xFFFFFFFFFFFFFFFF >> (64-size) : 0;
+            const uint64_t imask = ~mask;
+            const size_t byte_size = (size+7)/8;
+            for(unsigned int shift=0;shift<=(size+1);shift++){
+                for(uint64_t fill=0;fill<2;fill++){
+                    uint8_t result_be[8];
+                    bufops_store_be64(result_be,src);
+                    bufops_shrbits_be(result_be+8-byte_size,result_be+8-byte_size,size,shift,fill);
+                    const unsigned int tb_shift = shift>size ? size : shift;
+                    const uint64_t pad = (fill ? (1ull<<tb_shift)-1 : 0)<<(size-tb_shift);
+                    const uint64_t expected = ((src& mask)>>tb_shift)  | (src & imask) | pad;
+                    assert(expected==bufops_load_be64(result_be));
+                    if(size){
+                        const uint64_t dst_init[] = {src & imask, (src & imask) | (0xFFFFFFFFFFFFFFFF & mask), (src & imask) | (~expected & mask)};
+                        for(unsigned int k=0;k<sizeof(dst_init)/sizeof(uint64_t);k++){
+                            bufops_store_be64(result_be,dst_init[k]);
+                            bufops_shrbits_be(result_be+8-byte_size,src_be+8-byte_size,size,shift,fill);
+                            assert(expected==bufops_load_be64(result_be));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+void bufops_be_vs_le_test(void){
+    //long buffers, checked against the little endian functions on the reversed buffer
+    uint8_t src[40];
+    uint8_t ref[40];
+    uint8_t result[40];
+    uint32_t seed = 1;
+    for(unsigned int size=1;size<=8*sizeof(src);size++){
+        const size_t byte_size = (size+7)/8;
+        for(unsigned int shift=0;shift<=(size+1);shift++){
+            for(unsigned int fill=0;fill<2;fill++){
+                for(size_t i=0;i<byte_size;i++){
+                    seed = seed*1103515245+12345;
+                    src[i] = seed>>16;
+                }
+                for(unsigned int left=0;left<2;left++){
+                    memcpy(ref,src,byte_size);
+                    bufops_reverse(ref,byte_size);
+                    if(left) bufops_shlbits(ref,ref,size,shift,fill);
+                    else bufops_shrbits(ref,ref,size,shift,fill);
+                    bufops_reverse(ref,byte_size);
+                    memset(result,0x5A,byte_size);
+                    if(left) bufops_shlbits_be(result,src,size,shift,fill);
+                    else bufops_shrbits_be(result,src,size,shift,fill);
+                    assert(0==memcmp(ref,result,byte_size));
+                    memcpy(result,src,byte_size);
+                    if(left) bufops_shlbits_be(result,result,size,shift,fill);
+                    else bufops_shrbits_be(result,result,size,shift,fill);
+                    assert(0==memcmp(ref,result,byte_size));
+                }
+            }
+        }
+    }
+}
+void bufops_swap_test(void){
+    uint8_t buf[300];
+    uint8_t ref[300];
+    for(size_t size=0;size<sizeof(buf);size++){
+        for(size_t i=0;i<sizeof(ref);i++) ref[i] = (uint8_t)(i*131+size);
+        memcpy(buf,ref,size);
+        bufops_reverse(buf,size);
+        for(size_t i=0;i<size;i++) assert(buf[i]==ref[size-1-i]);
+        for(unsigned int lane=2;lane<=8;lane*=2){
+            memcpy(buf,ref,sizeof(buf));
+            const size_t n_words = size/lane;
+            if(2==lane) bufops_swap16(buf,n_words);
+            if(4==lane) bufops_swap32(buf,n_words);
+            if(8==lane) bufops_swap64(buf,n_words);
+            for(size_t i=0;i<n_words*lane;i++) assert(buf[i]==ref[(i/lane)*lane + lane-1-i%lane]);
+            for(size_t i=n_words*lane;i<sizeof(buf);i++) assert(buf[i]==ref[i]);//untouched
+        }
+    }
+}
 #endif
 
 #endif
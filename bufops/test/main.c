@@ -25,6 +25,10 @@ int main(int argc, char *argv[]){
     printf("testing bufshl and bufshr functions\n");
     bufops_bufshl_test();printf("bufshl_test PASS\n");
     bufops_bufshr_test();printf("bufshr_test PASS\n");
+    bufops_bufshl_be_test();printf("bufshl_be_test PASS\n");
+    bufops_bufshr_be_test();printf("bufshr_be_test PASS\n");
+    bufops_be_vs_le_test();printf("be_vs_le_test PASS\n");
+    bufops_swap_test();printf("swap_test PASS\n");
     uint8_t test[] = {0x12,0x34,0x56,0x78};
     char buf[128];
     bigint2str(buf,test,1);printf("*%s*\n",buf);assert(0==strcmp(buf,"0x12"));
@@ -0,0 +1,365 @@
+#ifndef __HEXLOAD_H__
+#define __HEXLOAD_H__
+//hexload_t
+//streaming loader for Intel HEX and Motorola S-record images, programming a paged memory
+//
+//records are parsed incrementally from chunks of any size (no need for whole lines or a null terminator),
+//checksums are verified and data is accumulated in a few page sized staging buffers.
+//a page is written with a single call to the write callback as soon as all its bytes are received,
+//pages left incomplete are written when they are evicted or by hexload_finish.
+//writes are planned with paged_op32_compute: they are aligned on the granularity and never cross a page,
+//bytes of an incomplete page which are not in the image are written with the fill value.
+//
+//a page written and later needed again (records out of order, more pages than staging buffers)
+//cannot be completed blindly: the write would overwrite what was programmed before with fill bytes.
+//with a read callback (hexload_set_read), the page is read back and merged before being written again,
+//without it the load fails with HEXLOAD_ERR_ORDER.
+//written pages are tracked as HEXLOAD_MAX_RANGES ranges, when there are more the closest ones are merged:
+//pages in between are then treated as written (read back, or HEXLOAD_ERR_ORDER).
+//
+//usage:
+//  uint8_t mem[HEXLOAD_MEM_SIZE(page_size,n_pages)];
+//  hexload_t h;
+//  hexload_init(&h,mem,n_pages,page_size,granularity,0xFF,write,ctx);
+//  while(...) if(hexload_feed(&h,chunk,chunk_len)) error;
+//  if(hexload_finish(&h)) error;
+//
+//the format is detected on each record (':' for Intel HEX, 'S' for S-record),
+//everything after an end of file / termination record is ignored.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "paged_op.h"
+
+#ifndef HEXLOAD_MAX_PAGES
+#define HEXLOAD_MAX_PAGES 8
+#endif
+
+#ifndef HEXLOAD_MAX_RANGES
+#define HEXLOAD_MAX_RANGES 16
+#endif
+
+//staging memory to provide to hexload_init: data and valid bitmap for each page
+#define HEXLOAD_MEM_SIZE(page_size,n_pages) ((n_pages)*((page_size)+((page_size)+7)/8))
+
+//longest record: Intel HEX with 255 data bytes
+#define HEXLOAD_MAX_RECORD (5+255)
+
+#define HEXLOAD_OK            0
+#define HEXLOAD_ERR_SYNTAX   -1 //unexpected character
+#define HEXLOAD_ERR_CHECKSUM -2
+#define HEXLOAD_ERR_RECORD   -3 //bad length or unsupported record type
+#define HEXLOAD_ERR_WRITE    -4 //write callback failed
+#define HEXLOAD_ERR_PARAM    -5
+#define HEXLOAD_ERR_ORDER    -6 //data for a page already written, and no read callback
+#define HEXLOAD_ERR_READ     -7 //read callback failed
+
+//write size bytes at addr, returns 0 on success
+typedef int (*hexload_write_t)(void *ctx, uint32_t addr, const uint8_t *data, uint32_t size);
+//read size bytes at addr, returns 0 on success
+typedef int (*hexload_read_t)(void *ctx, uint32_t addr, uint8_t *data, uint32_t size);
+
+typedef struct hexload_page_struct {
+    uint8_t *data;
+    uint8_t *valid;     //one bit per byte received
+    uint32_t page;
+    uint32_t filled;    //number of bytes received
+    uint32_t lo;        //lowest offset received
+    uint32_t hi;        //highest offset received + 1
+    uint32_t age;       //last use, for eviction
+    int used;
+} hexload_page_t;
+
+typedef struct hexload_struct {
+    uint32_t page_size;
+    uint32_t granularity;
+    uint8_t fill;
+    hexload_write_t write;
+    hexload_read_t read;    //optional, see hexload_set_read
+    void *ctx;
+    unsigned int n_pages;
+    hexload_page_t pages[HEXLOAD_MAX_PAGES];
+    uint32_t clock;
+    uint32_t written[HEXLOAD_MAX_RANGES][2];//first and last page of each range of written pages, sorted
+    unsigned int n_written;
+    //parser
+    uint8_t rec[HEXLOAD_MAX_RECORD];
+    unsigned int rec_len;   //number of bytes decoded in rec
+    int nibble;             //pending high nibble, -1 if none
+    char format;            //0 between records, ':' or 'S' within a record
+    uint8_t srec_type;      //0xFF while waiting for the S-record type digit
+    uint32_t base;          //Intel HEX extended segment/linear address
+    int done;               //end record seen
+    int error;              //first error, sticky
+    //information
+    uint32_t line;          //current line, starting from 1
+    uint32_t records;       //number of records processed
+    uint32_t writes;        //number of calls to write
+    uint32_t start_addr;    //from start address / termination records
+    int has_start_addr;
+} hexload_t;
+
+static int hexload_init(hexload_t *h, uint8_t *mem, unsigned int n_pages, uint32_t page_size, uint32_t granularity, uint8_t fill, hexload_write_t write, void *ctx){
+    memset(h,0,sizeof(hexload_t));
+    if((0==n_pages) || (n_pages>HEXLOAD_MAX_PAGES) || (0==granularity) || (0==page_size) || (page_size%granularity)){
+        h->error = HEXLOAD_ERR_PARAM;
+        return h->error;
+    }
+    h->page_size = page_size;
+    h->granularity = granularity;
+    h->fill = fill;
+    h->write = write;
+    h->ctx = ctx;
+    h->n_pages = n_pages;
+    for(unsigned int i=0;i<n_pages;i++){
+        h->pages[i].data = mem;
+        mem += page_size;
+        h->pages[i].valid = mem;
+        mem += (page_size+7)/8;
+    }
+    h->nibble = -1;
+    h->line = 1;
+    return HEXLOAD_OK;
+}
+
+//enable the merge of pages needed again after being written, read uses the ctx given to hexload_init
+static void hexload_set_read(hexload_t *h, hexload_read_t read){
+    h->read = read;
+}
+
+static int hexload_was_written(const hexload_t *h, uint32_t page){
+    for(unsigned int i=0;i<h->n_written;i++){
+        if((h->written[i][0]<=page) && (page<=h->written[i][1])) return 1;
+    }
+    return 0;
+}
+
+static void hexload_mark_written(hexload_t *h, uint32_t page){
+    if(hexload_was_written(h,page)) return;
+    if(HEXLOAD_MAX_RANGES==h->n_written){//merge the two closest ranges
+        unsigned int best = 0;
+        for(unsigned int i=1;i+1<h->n_written;i++){
+            if(h->written[i+1][0]-h->written[i][1] < h->written[best+1][0]-h->written[best][1]) best = i;
+        }
+        h->written[best][1] = h->written[best+1][1];
+        memmove(h->written[best+1],h->written[best+2],(h->n_written-best-2)*sizeof(h->written[0]));
+        h->n_written--;
+        if(hexload_was_written(h,page)) return;
+    }
+    unsigned int i=0;
+    while((i<h->n_written) && (h->written[i][0]<page)) i++;
+    const int join_prev = i && (h->written[i-1][1]+1==page);
+    const int join_next = (i<h->n_written) && (h->written[i][0]==page+1);
+    if(join_prev && join_next){
+        h->written[i-1][1] = h->written[i][1];
+        memmove(h->written[i],h->written[i+1],(h->n_written-i-1)*sizeof(h->written[0]));
+        h->n_written--;
+    } else if(join_prev){
+        h->written[i-1][1] = page;
+    } else if(join_next){
+        h->written[i][0] = page;
+    } else {
+        memmove(h->written[i+1],h->written[i],(h->n_written-i)*sizeof(h->written[0]));
+        h->written[i][0] = page;
+        h->written[i][1] = page;
+        h->n_written++;
+    }
+}
+
+//write the received part of a staged page and release it
+static int hexload_flush_page(hexload_t *h, hexload_page_t *p){
+    if(!p->used) return HEXLOAD_OK;
+    p->used = 0;
+    hexload_mark_written(h,p->page);
+    const uint32_t page_addr = p->page*h->page_size;
+    paged_op32_t op;
+    paged_op32_compute(&op,page_addr+p->lo,p->hi-p->lo,h->page_size,h->granularity);
+    h->writes++;
+    if(h->write(h->ctx,page_addr+op.first_offset,p->data+op.first_offset,op.first_size)) return HEXLOAD_ERR_WRITE;
+    return HEXLOAD_OK;
+}
+
+//staging buffer of page in *pp, a page written before starts from the content read back
+static int hexload_get_page(hexload_t *h, uint32_t page, hexload_page_t **pp){
+    hexload_page_t *victim = 0;
+    for(unsigned int i=0;i<h->n_pages;i++){
+        hexload_page_t *p = &h->pages[i];
+        if(p->used && (page==p->page)){
+            *pp = p;
+            return HEXLOAD_OK;
+        }
+        if(!victim || (victim->used && (!p->used || (p->age<victim->age)))) victim = p;
+    }
+    const int written = hexload_was_written(h,page);
+    if(written && !h->read) return HEXLOAD_ERR_ORDER;
+    if(victim->used){
+        const int status = hexload_flush_page(h,victim);
+        if(status) return status;
+    }
+    if(written){
+        if(h->read(h->ctx,page*h->page_size,victim->data,h->page_size)) return HEXLOAD_ERR_READ;
+    } else {
+        memset(victim->data,h->fill,h->page_size);
+    }
+    victim->used = 1;
+    victim->page = page;
+    victim->filled = 0;
+    victim->lo = h->page_size;
+    victim->hi = 0;
+    memset(victim->valid,0,(h->page_size+7)/8);
+    *pp = victim;
+    return HEXLOAD_OK;
+}
+
+static int hexload_data(hexload_t *h, uint32_t addr, const uint8_t *data, uint32_t size){
+    while(size){
+        const uint32_t offset = addr % h->page_size;
+        const uint32_t n = size < h->page_size-offset ? size : h->page_size-offset;
+        hexload_page_t *p;
+        const int status = hexload_get_page(h,addr/h->page_size,&p);
+        if(status) return status;
+        p->age = ++h->clock;
+        memcpy(p->data+offset,data,n);
+        for(uint32_t i=offset;i<offset+n;i++){
+            const uint8_t bit = 1<<(i%8);
+            if(0==(p->valid[i/8] & bit)){
+                p->valid[i/8] |= bit;
+                p->filled++;
+            }
+        }
+        if(offset<p->lo) p->lo = offset;
+        if(offset+n>p->hi) p->hi = offset+n;
+        if(p->filled==h->page_size){
+            const int flush_status = hexload_flush_page(h,p);
+            if(flush_status) return flush_status;
+        }
+        addr += n;
+        data += n;
+        size -= n;
+    }
+    return HEXLOAD_OK;
+}
+
+static int hexload_intel_record(hexload_t *h){
+    const uint8_t *r = h->rec;
+    if((h->rec_len<5) || (h->rec_len!=5u+r[0])) return HEXLOAD_ERR_RECORD;
+    uint8_t sum=0;
+    for(unsigned int i=0;i<h->rec_len;i++) sum += r[i];
+    if(sum) return HEXLOAD_ERR_CHECKSUM;
+    const uint32_t addr = (r[1]<<8) | r[2];
+    const uint8_t *d = r+4;
+    switch(r[3]){
+    case 0x00: return hexload_data(h,h->base+addr,d,r[0]);
+    case 0x01: h->done = 1; return HEXLOAD_OK;
+    case 0x02: if(2!=r[0]) return HEXLOAD_ERR_RECORD; h->base = ((d[0]<<8) | d[1])<<4; return HEXLOAD_OK;
+    case 0x04: if(2!=r[0]) return HEXLOAD_ERR_RECORD; h->base = (uint32_t)((d[0]<<8) | d[1])<<16; return HEXLOAD_OK;
+    case 0x03:
+        if(4!=r[0]) return HEXLOAD_ERR_RECORD;
+        h->start_addr = (((d[0]<<8) | d[1])<<4) + ((d[2]<<8) | d[3]);
+        h->has_start_addr = 1;
+        return HEXLOAD_OK;
+    case 0x05:
+        if(4!=r[0]) return HEXLOAD_ERR_RECORD;
+        h->start_addr = ((uint32_t)d[0]<<24) | (d[1]<<16) | (d[2]<<8) | d[3];
+        h->has_start_addr = 1;
+        return HEXLOAD_OK;
+    default: return HEXLOAD_ERR_RECORD;
+    }
+}
+
+static int hexload_srec_record(hexload_t *h){
+    //address length for each type, 0 for unsupported types
+    static const uint8_t addr_len[10] = {2,2,3,4,0,2,3,4,3,2};
+    const uint8_t *r = h->rec;
+    const unsigned int type = h->srec_type;
+    if((h->rec_len<2) || (h->rec_len!=1u+r[0])) return HEXLOAD_ERR_RECORD;
+    const unsigned int alen = addr_len[type];
+    if((0==alen) || (r[0]<alen+1)) return HEXLOAD_ERR_RECORD;
+    uint8_t sum=0;
+    for(unsigned int i=0;i<h->rec_len;i++) sum += r[i];
+    if(0xFF!=sum) return HEXLOAD_ERR_CHECKSUM;
+    uint32_t addr = 0;
+    for(unsigned int i=0;i<alen;i++) addr = (addr<<8) | r[1+i];
+    const uint8_t *d = r+1+alen;
+    const uint32_t n = r[0]-alen-1;
+    switch(type){
+    case 1: case 2: case 3: return hexload_data(h,addr,d,n);
+    case 7: case 8: case 9:
+        h->start_addr = addr;
+        h->has_start_addr = 1;
+        h->done = 1;
+        return HEXLOAD_OK;
+    default: return HEXLOAD_OK;//header and record counts
+    }
+}
+
+static int hexload_end_record(hexload_t *h){
+    int status;
+    if(h->nibble>=0) status = HEXLOAD_ERR_RECORD;
+    else if(0xFF==h->srec_type) status = HEXLOAD_ERR_SYNTAX;
+    else status = ':'==h->format ? hexload_intel_record(h) : hexload_srec_record(h);
+    h->format = 0;
+    h->records++;
+    return status;
+}
+
+//parse a chunk of the image, returns HEXLOAD_OK or the first error encountered
+static int hexload_feed(hexload_t *h, const char *chunk, size_t len){
+    for(size_t i=0;(i<len) && !h->error && !h->done;i++){
+        const char c = chunk[i];
+        int v = -1;
+        if(('0'<=c) && (c<='9')) v = c-'0';
+        else if(('A'<=c) && (c<='F')) v = c-'A'+10;
+        else if(('a'<=c) && (c<='f')) v = c-'a'+10;
+        if(0==h->format){
+            if((':'==c) || ('S'==c)){
+                h->format = c;
+                h->rec_len = 0;
+                h->nibble = -1;
+                h->srec_type = ':'==c ? 0 : 0xFF;
+            } else if(('\n'==c) || ('\r'==c) || (' '==c) || ('\t'==c)){
+                if('\n'==c) h->line++;
+            } else {
+                h->error = HEXLOAD_ERR_SYNTAX;
+            }
+        } else if(0xFF==h->srec_type){
+            if(v<0 || v>9) h->error = HEXLOAD_ERR_SYNTAX;
+            else h->srec_type = v;
+        } else if(v>=0){
+            if(h->nibble<0){
+                h->nibble = v;
+            } else {
+                if(h->rec_len==HEXLOAD_MAX_RECORD){
+                    h->error = HEXLOAD_ERR_RECORD;
+                } else {
+                    h->rec[h->rec_len++] = (h->nibble<<4) | v;
+                    h->nibble = -1;
+                }
+            }
+        } else if(('\n'==c) || ('\r'==c)){
+            h->error = hexload_end_record(h);
+            if('\n'==c) h->line++;
+        } else {
+            h->error = HEXLOAD_ERR_SYNTAX;
+        }
+    }
+    return h->error;
+}
+
+//process a last record not followed by a new line and write the pages still staged
+static int hexload_finish(hexload_t *h){
+    if(!h->error && !h->done && h->format) h->error = hexload_end_record(h);
+    if(h->error) return h->error;
+    for(unsigned int i=0;i<h->n_pages;i++){
+        const int status = hexload_flush_page(h,&h->pages[i]);
+        if(status){
+            h->error = status;
+            return status;
+        }
+    }
+    return HEXLOAD_OK;
+}
+
+#endif //__HEXLOAD_H__
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#define HAS_ASSERT
+#include "hexload.h"
+
+//device model: paged memory checking each write
+#define MEM_SIZE 0x30000
+static uint8_t device[MEM_SIZE];
+static uint32_t page_size;
+static uint32_t granularity;
+static uint32_t n_writes;
+static int dev_write(void *ctx, uint32_t addr, const uint8_t *data, uint32_t size){
+    (void)ctx;
+    assert(0==(addr%granularity));
+    assert(0==(size%granularity));
+    assert(size);
+    assert(addr/page_size==(addr+size-1)/page_size);
+    assert(addr+size<=MEM_SIZE);
+    memcpy(device+addr,data,size);
+    n_writes++;
+    return 0;
+}
+
+static uint32_t n_reads;
+static int dev_read(void *ctx, uint32_t addr, uint8_t *data, uint32_t size){
+    (void)ctx;
+    assert(0==(addr%page_size));
+    assert(size==page_size);
+    assert(addr+size<=MEM_SIZE);
+    memcpy(data,device+addr,size);
+    n_reads++;
+    return 0;
+}
+
+//image: expected content, 0xFF where there is no data
+static uint8_t image[MEM_SIZE];
+static char text[8*MEM_SIZE];
+static size_t text_len;
+
+static void emit(const char *fmt, const uint8_t *bytes, unsigned int n, uint8_t checksum){
+    text_len += sprintf(text+text_len,"%s",fmt);
+    for(unsigned int i=0;i<n;i++) text_len += sprintf(text+text_len,"%02X",bytes[i]);
+    text_len += sprintf(text+text_len,"%02X\r\n",checksum);
+}
+static void intel_record(uint8_t type, uint16_t addr, const uint8_t *data, unsigned int n){
+    uint8_t r[4+255];
+    r[0]=n; r[1]=addr>>8; r[2]=addr; r[3]=type;
+    if(n) memcpy(r+4,data,n);
+    uint8_t sum=0;
+    for(unsigned int i=0;i<4+n;i++) sum+=r[i];
+    emit(":",r,4+n,-sum);
+}
+static void srec_record(char type, uint32_t addr, unsigned int alen, const uint8_t *data, unsigned int n){
+    uint8_t r[1+4+255];
+    r[0]=alen+n+1;
+    for(unsigned int i=0;i<alen;i++) r[1+i] = addr>>(8*(alen-1-i));
+    if(n) memcpy(r+1+alen,data,n);
+    uint8_t sum=0;
+    for(unsigned int i=0;i<1+alen+n;i++) sum+=r[i];
+    char start[3]={'S',type,0};
+    emit(start,r,1+alen+n,~sum);
+}
+
+//random fragmented image: segments made of records of random length, ascending addresses
+//with shuffle, the records are emitted in random order
+#define MAX_RECORDS MEM_SIZE
+static uint32_t rec_addr[MAX_RECORDS];
+static uint8_t rec_len[MAX_RECORDS];
+static uint32_t make_image(int srec, int shuffle){
+    uint32_t n_pages_touched = 0;
+    uint32_t last_page = ~0u;
+    uint32_t n_records = 0;
+    memset(image,0xFF,MEM_SIZE);
+    uint32_t addr = rand()%64;
+    while(addr<MEM_SIZE-300){
+        const unsigned int n = 1+rand()%48;
+        if(!srec && ((addr&0xFFFF)+n>0x10000)){//keep records within the 64 KiB window
+            addr = (addr|0xFFFF)+1;
+            continue;
+        }
+        for(unsigned int i=0;i<n;i++) image[addr+i] = rand();
+        rec_addr[n_records] = addr;
+        rec_len[n_records] = n;
+        n_records++;
+        for(uint32_t a=addr;a<addr+n;a++){
+            if(a/page_size!=last_page){
+                last_page = a/page_size;
+                n_pages_touched++;
+            }
+        }
+        addr += n;
+        if(0==rand()%8) addr += rand()%(3*page_size);//gap
+    }
+    if(shuffle){
+        for(uint32_t i=n_records-1;i>0;i--){
+            const uint32_t k = rand()%(i+1);
+            const uint32_t a = rec_addr[i]; rec_addr[i] = rec_addr[k]; rec_addr[k] = a;
+            const uint8_t l = rec_len[i]; rec_len[i] = rec_len[k]; rec_len[k] = l;
+        }
+    }
+    text_len = 0;
+    if(srec) srec_record('0',0,2,(const uint8_t*)"hdr",3);
+    uint32_t base = ~0u;
+    for(uint32_t r=0;r<n_records;r++){
+        addr = rec_addr[r];
+        if(srec){
+            srec_record('3',addr,4,image+addr,rec_len[r]);
+        } else {
+            if(base!=(addr>>16)){
+                base = addr>>16;
+                const uint8_t ext[2]={base>>8,base};
+                intel_record(4,0,ext,2);
+            }
+            intel_record(0,addr,image+addr,rec_len[r]);
+        }
+    }
+    if(srec) srec_record('7',0x1234,4,0,0);
+    else {
+        const uint8_t start[4]={0,0,0x12,0x34};
+        intel_record(5,0,start,4);
+        intel_record(1,0,0,0);
+    }
+    return n_pages_touched;
+}
+
+static int load_ex(unsigned int n_pages, hexload_t *h, hexload_read_t read){
+    static uint8_t mem[HEXLOAD_MEM_SIZE(4096,HEXLOAD_MAX_PAGES)];
+    memset(device,0xFF,MEM_SIZE);
+    n_writes = 0;
+    n_reads = 0;
+    const int init_status = hexload_init(h,mem,n_pages,page_size,granularity,0xFF,dev_write,0);
+    assert(0==init_status);
+    hexload_set_read(h,read);
+    size_t pos = 0;
+    while(pos<text_len){
+        const size_t n = 1+rand()%100;
+        const size_t len = pos+n<text_len ? n : text_len-pos;
+        const int status = hexload_feed(h,text+pos,len);
+        if(status) return status;
+        pos += len;
+    }
+    return hexload_finish(h);
+}
+static int load(unsigned int n_pages, hexload_t *h){return load_ex(n_pages,h,0);}
+
+static void load_test(void){
+    const uint32_t geometries[][2] = {{256,4},{4096,8},{96,3},{512,1},{64,64}};
+    for(unsigned int g=0;g<sizeof(geometries)/sizeof(geometries[0]);g++){
+        page_size = geometries[g][0];
+        granularity = geometries[g][1];
+        for(int srec=0;srec<2;srec++){
+            for(unsigned int n_pages=1;n_pages<=3;n_pages++){
+                const uint32_t touched = make_image(srec,0);
+                hexload_t h;
+                const int status = load(n_pages,&h);
+                assert(HEXLOAD_OK==status);
+                assert(0==memcmp(device,image,MEM_SIZE));
+                assert(h.has_start_addr && (0x1234==h.start_addr));
+                //ascending image: each page is written once
+                assert(touched==n_writes);
+                assert(touched==h.writes);
+                assert(0==n_reads);
+            }
+        }
+        printf("page_size=%4u, granularity=%2u: PASS\n",page_size,granularity);
+    }
+}
+
+//records in random order, pages evicted and needed again
+static void shuffle_test(void){
+    const uint32_t geometries[][2] = {{256,4},{96,3},{64,64},{16,16}};
+    for(unsigned int g=0;g<sizeof(geometries)/sizeof(geometries[0]);g++){
+        page_size = geometries[g][0];
+        granularity = geometries[g][1];
+        for(int srec=0;srec<2;srec++){
+            for(unsigned int n_pages=1;n_pages<=3;n_pages++){
+                make_image(srec,1);
+                hexload_t h;
+                int status = load_ex(n_pages,&h,dev_read);
+                assert(HEXLOAD_OK==status);
+                assert(0==memcmp(device,image,MEM_SIZE));
+                assert(n_reads);
+                //without read back, refused instead of losing data
+                status = load(n_pages,&h);
+                assert(HEXLOAD_ERR_ORDER==status);
+            }
+        }
+        printf("shuffled page_size=%4u, granularity=%2u: PASS\n",page_size,granularity);
+    }
+    //records at 0x00, 0x10 then 0x08 with a single 16 byte page
+    page_size = 16;
+    granularity = 16;
+    text_len = 0;
+    const uint8_t a[4] = {0x11,0x22,0x33,0x44};
+    const uint8_t b[4] = {0xAA,0xBB,0xCC,0xDD};
+    const uint8_t c[4] = {0x55,0x66,0x77,0x88};
+    intel_record(0,0x00,a,4);
+    intel_record(0,0x10,b,4);
+    intel_record(0,0x08,c,4);
+    intel_record(1,0,0,0);
+    memset(image,0xFF,MEM_SIZE);
+    memcpy(image+0x00,a,4);
+    memcpy(image+0x10,b,4);
+    memcpy(image+0x08,c,4);
+    hexload_t h;
+    int status = load(1,&h);
+    assert(HEXLOAD_ERR_ORDER==status);
+    status = load_ex(1,&h,dev_read);
+    assert(HEXLOAD_OK==status);
+    assert(0==memcmp(device,image,MEM_SIZE));
+    assert(3==n_writes);
+    assert(1==n_reads);
+    printf("shuffle: PASS\n");
+}
+
+static void error_test(void){
+    hexload_t h;
+    int status;
+    page_size = 256;
+    granularity = 4;
+    make_image(0,0);
+    text[1] ^= 1;//byte count
+    status = load(2,&h);
+    assert(HEXLOAD_ERR_RECORD==status);
+    make_image(0,0);
+    text[text_len/2] = 'G';
+    status = load(2,&h);
+    assert(HEXLOAD_ERR_SYNTAX==status);
+    make_image(1,0);
+    char *p = strstr(text,"\r\nS3")+6;
+    *p = '0'==*p ? '1' : '0';
+    status = load(2,&h);
+    assert(HEXLOAD_ERR_CHECKSUM==status);
+    assert(2==h.line);//S0 header is line 1
+    make_image(1,0);
+    text[strstr(text,"\r\nS3")-text+3] = '4';//S4 is reserved
+    status = load(2,&h);
+    assert(HEXLOAD_ERR_RECORD==status);
+    //last record without new line, then data after the end record is ignored
+    text_len = 0;
+    const uint8_t d[4] = {1,2,3,4};
+    intel_record(0,0x10,d,4);
+    intel_record(1,0,0,0);
+    text_len -= 2;
+    memset(image,0xFF,MEM_SIZE);
+    memcpy(image+0x10,d,4);
+    status = load(1,&h);
+    assert(HEXLOAD_OK==status);
+    assert(0==memcmp(device,image,MEM_SIZE));
+    text_len += sprintf(text+text_len,"\r\ngarbage");
+    status = load(1,&h);
+    assert(HEXLOAD_OK==status);
+    assert(0==memcmp(device,image,MEM_SIZE));
+    printf("errors: PASS\n");
+}
+
+int main(int argc, char *argv[]){
+    (void)argc;(void)argv;
+    srand(0);
+    load_test();
+    shuffle_test();
+    error_test();
+    printf("TEST PASS\n");
+}
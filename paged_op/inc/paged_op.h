@@ -10,9 +10,11 @@
 //
 //see paged_op32_test_case function in the test code for an example of usage
 //
-// WARNING: this is tested only with granularity being a power of 2
+// WARNING: this is tested only with page_size being a multiple of granularity
+// (granularity does not need to be a power of 2)
 
 #include <stdint.h>
+#include <string.h>
 
 static void paged_op32_match_granularity_lo(uint32_t*size,uint32_t granularity){
     const uint32_t s_mod_gra = *size % granularity;
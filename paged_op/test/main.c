@@ -1,4 +1,4 @@
-
+#define _POSIX_C_SOURCE 200809L
 
 #include <stdio.h>
 #include <assert.h>
@@ -11,115 +11,199 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 
-#include "printx.h"
+//exhaustive verification of paged_op32_compute
+//
+//each geometry (word size, words per page, pages) is checked for every (offset,size) pair of the memory.
+//instead of reading the memory and comparing checksums, we check the plan itself:
+//  - each access is aligned on the granularity and stays within one page
+//  - each processed range lies within the data returned by its access
+//  - processed ranges are contiguous and cover exactly [offset,offset+size)
+//this costs O(accesses) per case instead of O(size), and the offset space is sharded across threads
 
-#ifndef MEM_WORD_SIZE
-#define MEM_WORD_SIZE       8
-#endif
-#ifndef MEM_WORD_PER_PAGE
-#define MEM_WORD_PER_PAGE   4
-#endif
+#define DEFAULT_MEM_PAGES 32
 
-#define MEM_PAGE_SIZE       (MEM_WORD_PER_PAGE*MEM_WORD_SIZE)
-#define MEM_PAGES           11
-#define MEM_SIZE            (MEM_PAGES*MEM_PAGE_SIZE)
+typedef struct geometry_struct {
+    uint32_t word_size;     //granularity in bytes
+    uint32_t words_per_page;
+    uint32_t pages;
+} geometry_t;
 
-#if MEM_WORD_SIZE == 1
-uint8_t mem[MEM_PAGES][MEM_WORD_PER_PAGE];
-#endif
-#if MEM_WORD_SIZE == 2
-uint16_t mem[MEM_PAGES][MEM_WORD_PER_PAGE];
-#endif
-#if MEM_WORD_SIZE == 4
-uint32_t mem[MEM_PAGES][MEM_WORD_PER_PAGE];
-#endif
-#if MEM_WORD_SIZE == 8
-uint64_t mem[MEM_PAGES][MEM_WORD_PER_PAGE];
-#endif
+typedef struct shard_struct {
+    geometry_t geo;
+    uint32_t first_offset;  //offsets processed: first_offset, first_offset+stride, ...
+    uint32_t stride;
+    uint64_t cases;
+    uint64_t accesses;
+    uint64_t bytes;
+    uint32_t fail_offset;
+    uint32_t fail_size;
+    int failed;
+} shard_t;
 
-void access (uint8_t*buf, uint32_t offset, uint32_t size){
-    //printf("\taccess offset=%u, size=%u\n",offset,size);
-    if(0==size) return;
-    assert(0==(offset % MEM_WORD_SIZE));//granularity check
-    assert(0==(size   % MEM_WORD_SIZE));//granularity check
-    const uint32_t page = offset / MEM_PAGE_SIZE;
-    //printf("\t\tpage=%u, (offset+size-1)/MEM_PAGE_SIZE=%u\n",page,(offset+size-1)/MEM_PAGE_SIZE);
-    assert(page==((offset+size-1)/MEM_PAGE_SIZE));//page_size check
-    const uint32_t page_offset = (offset % MEM_PAGE_SIZE) / MEM_WORD_SIZE;
-    const uint32_t words = size/MEM_WORD_SIZE;
-    //printf("\t");
-    for(uint32_t i=0;i<words;i++){
-        uint64_t word = mem[page][page_offset+i];
-        //printf("%016lx ",word);
-        memcpy(buf+i*MEM_WORD_SIZE,&word,MEM_WORD_SIZE);
-    }
-    //printf("\n");
-}
-
-uint64_t checksum;
-void process(uint8_t*buf, uint32_t offset, uint32_t size){
-    //printf("\tprocess offset=%u, size=%u\n",offset,size);
-    //printf("\t");
-    for(uint32_t i=0;i<size;i++){
-        //printf("%02x ",buf[offset+i]);
-        checksum+=buf[offset+i];
-    }
-    //printf("\n");
-}
-
-//we model the processing by a call to:     process(uint8_t*buf, uint32_t offset, uint32_t size)
-//we model the access to data by a call to: access (uint8_t*buf, uint32_t offset, uint32_t size)
+//we model the access to data by a call to: access (offset, size)
+//we model the processing by a call to:     process(buf_offset, buf_size) where buf is the data returned by access
 //
-static void paged_op32_test_case(uint32_t offset,uint32_t size){
-    //printf("test_case %u, %u\n",offset,size);
-    const uint32_t page_size = MEM_PAGE_SIZE;
-    const uint32_t granularity = MEM_WORD_SIZE;
+//returns 0 if the plan covers exactly [offset,offset+size) with legal accesses
+static int paged_op32_test_case(shard_t *s, uint32_t offset, uint32_t size){
+    const uint32_t page_size = s->geo.word_size * s->geo.words_per_page;
+    const uint32_t granularity = s->geo.word_size;
+    const uint32_t mem_size = page_size * s->geo.pages;
     paged_op32_t op;
     paged_op32_compute(&op, offset, size, page_size, granularity);
-    //paged_op32_dump(stdout,"\t",&op);
     uint32_t acc_offset = op.first_offset;
     uint32_t acc_size   = op.first_size;
     uint32_t buf_offset = op.first_buf_offset;
     uint32_t buf_size   = op.first_buf_size;
-    uint8_t buf[page_size];
-    for(uint32_t page=op.first_page;page<op.last_page;page++){//do first and all full page accesses
-        access(buf,page*page_size+acc_offset,acc_size);
-        process(buf,buf_offset,buf_size);//note process is optional and can be done before access for write operation
+    uint32_t expected   = offset;//next address to process
+    uint32_t n_pages = op.last_page + (op.last_size ? 1 : 0);
+    if(0==size) n_pages = 0;
+    for(uint32_t page=op.first_page;page<n_pages;page++){
+        if(page==op.last_page){//last page access if not a full page
+            acc_offset = 0;
+            acc_size   = op.last_size;
+            buf_offset = 0;
+            buf_size   = op.last_buf_size;
+        }
+        const uint32_t addr = page*page_size+acc_offset;
+        if(acc_size){
+            if(acc_offset % granularity) return 1;
+            if(acc_size % granularity) return 1;
+            if(acc_offset+acc_size > page_size) return 1;
+            if(addr+acc_size > mem_size) return 1;
+            s->accesses++;
+        }
+        if(buf_offset+buf_size > acc_size) return 1;
+        if(addr+buf_offset != expected) return 1;
+        expected += buf_size;
         acc_offset = 0;
         acc_size   = page_size;
         buf_offset = 0;
         buf_size   = page_size;
     }
-    if(op.last_size){//do last page access if not a full page
-        access(buf,op.last_page*page_size,op.last_size);
-        process(buf,0,op.last_buf_size);//note process is optional and can be done before access for write operation
+    return expected != offset+size;
+}
+
+static void *shard_run(void *arg){
+    shard_t *s = (shard_t*)arg;
+    const uint32_t mem_size = s->geo.word_size * s->geo.words_per_page * s->geo.pages;
+    for(uint32_t offset = s->first_offset; offset < mem_size; offset+=s->stride){
+        for(uint32_t size = 0; size < mem_size-offset +1; size++){
+            s->cases++;
+            s->bytes+=size;
+            if(paged_op32_test_case(s,offset,size)){
+                s->failed = 1;
+                s->fail_offset = offset;
+                s->fail_size = size;
+                return 0;
+            }
+        }
     }
+    return 0;
+}
+
+static double now_seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static void usage(const char *name){
+    printf("usage: %s [-j threads] [-p pages] [-g word_size:words_per_page[:pages]]...\n",name);
+    printf("without -g, all default geometries are checked\n");
 }
 
 #define NUM_ELEMS(a) (sizeof(a)/sizeof 0[a])
 int main(int argc, char *argv[]){
-    printf("MEM_WORD_SIZE=%3u and MEM_WORD_PER_PAGE=%3u: ",MEM_WORD_SIZE,MEM_WORD_PER_PAGE);
-    fflush(stdout);
-    uint8_t mem_ref[MEM_SIZE];
-    srand(0);
-    for(int i=0;i<MEM_SIZE;i++) mem_ref[i] = rand();
-    memcpy(mem,mem_ref,MEM_SIZE);
-    for(uint32_t offset = 0; offset < MEM_SIZE; offset++){
-        for(uint32_t size = 0; size < MEM_SIZE-offset +1; size++){
-            //printf("--- offset=%u, size=%u\n",offset,size);
-            checksum=0;
-            process(mem_ref,offset,size);
-            const uint64_t checksum_ref=checksum;
-            checksum=0;
-            paged_op32_test_case(offset,size);
-            if(checksum_ref!=checksum){
-                printf("\n--- offset=%u, size=%u\n",offset,size);
-                printx32_dump_buf64("mem\n",mem,sizeof(mem),0);
-                assert(0);
+    //word size, max words per page
+    //powers of 2 match the geometries of the former per-geometry builds
+    const uint32_t default_geometries[][2] = {
+        {1, 4},{2, 5},{3, 9},{4,16},{5, 7},{6,10},{8,17},{12, 6},{16, 4},
+    };
+    unsigned int max_geos = argc;
+    for(unsigned int i=0;i<NUM_ELEMS(default_geometries);i++) max_geos += default_geometries[i][1];
+    geometry_t *geos = (geometry_t*)malloc(sizeof(geometry_t)*max_geos);
+    unsigned int n_geos = 0;
+    uint32_t pages = DEFAULT_MEM_PAGES;
+    long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    for(int i=1;i<argc;i++){
+        if(0==strcmp(argv[i],"-j") && i+1<argc){
+            n_threads = atol(argv[++i]);
+        } else if(0==strcmp(argv[i],"-p") && i+1<argc){
+            pages = atol(argv[++i]);
+        } else if(0==strcmp(argv[i],"-g") && i+1<argc){
+            geometry_t g = {0,0,0};
+            if(sscanf(argv[++i],"%u:%u:%u",&g.word_size,&g.words_per_page,&g.pages)<2) {usage(argv[0]);return 1;}
+            geos[n_geos++] = g;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if(n_threads<1) n_threads = 1;
+    if(0==n_geos){
+        for(unsigned int i=0;i<NUM_ELEMS(default_geometries);i++){
+            for(uint32_t wpp=1;wpp<=default_geometries[i][1];wpp++){
+                geometry_t g = {default_geometries[i][0],wpp,0};
+                geos[n_geos++] = g;
+            }
+        }
+    }
+    shard_t *shards = (shard_t*)malloc(sizeof(shard_t)*n_threads);
+    pthread_t *threads = (pthread_t*)malloc(sizeof(pthread_t)*n_threads);
+    uint64_t total_cases=0;
+    uint64_t total_accesses=0;
+    uint64_t total_bytes=0;
+    int failed = 0;
+    const double start = now_seconds();
+    for(unsigned int g=0;g<n_geos;g++){
+        geometry_t geo = geos[g];
+        if(0==geo.pages) geo.pages = pages;
+        if((0==geo.word_size) || (0==geo.words_per_page) || (0==geo.pages)) {usage(argv[0]);return 1;}
+        const uint32_t mem_size = geo.word_size * geo.words_per_page * geo.pages;
+        printf("MEM_WORD_SIZE=%3u and MEM_WORD_PER_PAGE=%3u, MEM_PAGES=%3u: ",geo.word_size,geo.words_per_page,geo.pages);
+        fflush(stdout);
+        const double geo_start = now_seconds();
+        for(long t=0;t<n_threads;t++){
+            memset(&shards[t],0,sizeof(shard_t));
+            shards[t].geo = geo;
+            shards[t].first_offset = t;
+            shards[t].stride = n_threads;
+            pthread_create(&threads[t],0,shard_run,&shards[t]);
+        }
+        uint64_t cases=0;
+        for(long t=0;t<n_threads;t++){
+            pthread_join(threads[t],0);
+            cases += shards[t].cases;
+            total_accesses += shards[t].accesses;
+            total_bytes += shards[t].bytes;
+            if(shards[t].failed){
+                paged_op32_t op;
+                failed = 1;
+                printf("\n--- offset=%u, size=%u\n",shards[t].fail_offset,shards[t].fail_size);
+                paged_op32_compute(&op,shards[t].fail_offset,shards[t].fail_size,geo.word_size*geo.words_per_page,geo.word_size);
+                paged_op32_dump(stdout,"\t",&op);
             }
         }
+        total_cases += cases;
+        const uint64_t expected_cases = (uint64_t)(mem_size+1)*(mem_size+2)/2 - 1;
+        if(failed) break;
+        assert(cases==expected_cases);
+        printf("%10llu cases in %8.3fs TEST PASS\n",(unsigned long long)cases,now_seconds()-geo_start);
+    }
+    const double elapsed = now_seconds()-start;
+    printf("coverage: %u geometries, %llu cases, %llu accesses, %llu bytes\n",n_geos,(unsigned long long)total_cases,(unsigned long long)total_accesses,(unsigned long long)total_bytes);
+    printf("wall time: %.3fs with %ld threads\n",elapsed,n_threads);
+    free(threads);
+    free(shards);
+    free(geos);
+    if(failed){
+        printf("TEST FAIL\n");
+        return 1;
     }
-    //printx_dump_buf64("mem\n",mem,sizeof(mem));
     printf("TEST PASS\n");
+    return 0;
 }
@@ -0,0 +1,106 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//benchmark of integer formatting: current print.h against the former digit per iteration implementation
+
+static volatile unsigned int sink;
+
+#define PRINT_PREFIX bench_
+static void bench_print_impl(const char*msg){sink+=msg[0];}
+#include "print.h"
+
+//former implementation, kept as reference
+static void ref_print(const char*msg){sink+=msg[0];}
+static void ref_print_uint_as_hex(uint64_t num, unsigned int nhexdigits){
+  const char hex[16]={'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
+
+  uint8_t car;
+  nhexdigits = nhexdigits < 16 ? nhexdigits : 16;
+  uint8_t i = nhexdigits;
+  char str_num[17];
+  str_num[i] = 0;
+  while (i > 0){
+    --i;
+    car = num & 0xF;
+    str_num[i] = hex[car];
+    num >>= 4;
+  }
+  ref_print(str_num);
+}
+static void ref_print_uint_as_dec(uint64_t num, unsigned int ndecdigits){
+  char res[21];
+  char* resptr = &res[20];
+  *resptr=0;
+  uint64_t t=num;
+  unsigned int l=0;
+  char zero='0';
+  do{
+    uint64_t d=t/10;
+    uint64_t m=t-10*d;
+    *--resptr = zero+m;
+    l++;
+    zero=d ? zero : ' ';//replace leading zeroes by blank
+    t=d;
+  } while (t!=0);
+  while(l<ndecdigits){
+      *--resptr = ' ';
+      l++;
+  }
+  ref_print(resptr);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS_UNIT "cycles"
+static uint64_t ticks(void){return __rdtsc();}
+#else
+#define TICKS_UNIT "ns"
+static uint64_t ticks(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (uint64_t)ts.tv_sec*1000000000+ts.tv_nsec;
+}
+#endif
+
+#define N_VALUES 4096
+#define N_REPS   64
+static uint64_t values[N_VALUES];
+
+typedef void (*fmt_func_t)(uint64_t num, unsigned int ndigits);
+
+//best of N_REPS runs over all values, in ticks per number
+static double bench(fmt_func_t f, unsigned int ndigits){
+  uint64_t best=~0ull;
+  for(unsigned int r=0;r<N_REPS;r++){
+    const uint64_t start=ticks();
+    for(unsigned int i=0;i<N_VALUES;i++) f(values[i],ndigits);
+    const uint64_t t=ticks()-start;
+    if(t<best) best=t;
+  }
+  return (double)best/N_VALUES;
+}
+
+int main(void){
+  const struct {const char*name; unsigned int bits;} sets[] = {
+    {"8 bit ",8},{"16 bit",16},{"32 bit",32},{"64 bit",64},
+  };
+  uint64_t x=0x0123456789ABCDEFull;
+  printf("%s per number       old      new  speedup\n",TICKS_UNIT);
+  for(unsigned int s=0;s<sizeof(sets)/sizeof(sets[0]);s++){
+    for(unsigned int i=0;i<N_VALUES;i++){
+      x^=x<<13;x^=x>>7;x^=x<<17;
+      values[i] = sets[s].bits<64 ? x & ((1ull<<sets[s].bits)-1) : x;
+    }
+    const unsigned int nhex=sets[s].bits/4;
+    const unsigned int ndec=sets[s].bits<64 ? 10 : 20;
+    const double ref_dec=bench(ref_print_uint_as_dec,ndec);
+    const double new_dec=bench(bench_print_uint_as_dec,ndec);
+    const double ref_hex=bench(ref_print_uint_as_hex,nhex);
+    const double new_hex=bench(bench_print_uint_as_hex,nhex);
+    printf("%s dec          %8.1f %8.1f %7.2fx\n",sets[s].name,ref_dec,new_dec,ref_dec/new_dec);
+    printf("%s hex          %8.1f %8.1f %7.2fx\n",sets[s].name,ref_hex,new_hex,ref_hex/new_hex);
+  }
+  return 0;
+}
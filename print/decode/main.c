@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "print_decode.h"
+
+//decode a print.h binary mode stream from stdin to stdout
+
+static void out(void*ctx, const char*text, size_t len){
+    fwrite(text,1,len,(FILE*)ctx);
+}
+
+int main(int argc, char *argv[]){
+    (void)argv;
+    if(argc>1){
+        fprintf(stderr,"usage: print_decode < records > text\n");
+        return 1;
+    }
+    print_decode_t d;
+    if(print_decode_init(&d,out,stdout)) return 1;
+    size_t cap = 1<<16;
+    size_t size = 0;
+    uint8_t *buf = (uint8_t*)malloc(cap);
+    int status = 0;
+    for(;;){
+        if(size==cap){//incomplete record larger than the buffer
+            cap*=2;
+            buf = (uint8_t*)realloc(buf,cap);
+            if(0==buf) return 1;
+        }
+        const size_t n = fread(buf+size,1,cap-size,stdin);
+        if(0==n) break;
+        size += n;
+        size_t consumed;
+        if(print_decode(&d,buf,size,&consumed)){
+            fprintf(stderr,"\nmalformed record\n");
+            status = 1;
+            break;
+        }
+        memmove(buf,buf+consumed,size-consumed);
+        size -= consumed;
+    }
+    if((0==status) && size){
+        fprintf(stderr,"\ntruncated record\n");
+        status = 1;
+    }
+    free(buf);
+    print_decode_free(&d);
+    return status;
+}
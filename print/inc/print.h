@@ -11,6 +11,38 @@
 
 //shall be included after the definition of print_impl function
 //void <PRINT_PREFIX>_print_impl(const char*msg);
+//
+//optional line buffer, to be defined next to PRINT_PREFIX:
+//#define PRINT_BUFFER_SIZE 128
+//fragments are collected and print_impl is called once per line,
+//when the buffer is full or when <PRINT_PREFIX>print_flush is called.
+//
+//optional lock-free multi producer ring, to be defined next to PRINT_BUFFER_SIZE:
+//#define PRINT_RING_SLOTS 64
+//lines are assembled in a per thread buffer (PRINT_RING_TLS, default __thread)
+//and committed whole into one of the PRINT_RING_SLOTS slots (power of 2) with an atomic claim.
+//a single consumer calls <PRINT_PREFIX>print_ring_drain to pass committed lines to print_impl.
+//producers never block: lines which do not fit are dropped and counted, see <PRINT_PREFIX>print_ring_dropped.
+//lines longer than PRINT_BUFFER_SIZE-1 characters are dropped and counted too, they are never split.
+//<PRINT_PREFIX>print_ring_write commits a string without using the per thread buffer (for ISRs).
+//requires gcc __atomic builtins.
+//
+//optional binary mode, to be defined next to PRINT_PREFIX:
+//#define PRINT_BINARY
+//instead of text, compact records (see print_bin.h) are passed to
+//void <PRINT_PREFIX>print_bin_impl(const uint8_t*rec, unsigned int size);
+//each call is one record: the id of its format (function and strings) and the raw value.
+//formats are sent once, up to PRINT_BINARY_FORMATS (power of 2, default 64) get an id, others are sent with each call.
+//strings are identified by their address: they shall not be modified once printed (string literals),
+//unless PRINT_BINARY_CHECK is defined, which hashes their content on each call.
+//print_decode.h turns the records back into the text of the normal mode.
+//
+//optional compile time level, to be defined next to PRINT_PREFIX:
+//#define PRINT_LEVEL PRINT_LEVEL_INFO
+//calls made through PRINT_LOG(<PRINT_PREFIX>,level,function,args...) or PRINT_ERROR/WARN/INFO/DEBUG/TRACE
+//are removed, arguments included, when level is above PRINT_LEVEL (default PRINT_LEVEL_ALL).
+//the remaining calls still obey <PRINT_PREFIX>print_cfg.
+//example: PRINT_DEBUG(uart0_,println32x,"x=0x",x); calls uart0_println32x("x=0x",x) if uart0_ has PRINT_LEVEL_DEBUG
 
 #include <stdint.h>
 #include <stdbool.h>
@@ -26,13 +58,178 @@
 #define PP_CONCAT(x, y) PP_CONCAT_IMPL( x, y )
 #endif
 
+#ifndef PRINT_LOG
+#define PRINT_LEVEL_NONE  0
+#define PRINT_LEVEL_ERROR 1
+#define PRINT_LEVEL_WARN  2
+#define PRINT_LEVEL_INFO  3
+#define PRINT_LEVEL_DEBUG 4
+#define PRINT_LEVEL_TRACE 5
+#define PRINT_LEVEL_ALL   PRINT_LEVEL_TRACE
+//the condition is a constant expression, so the compiler drops the call when it is false
+#define PRINT_LOG(prefix,level,function,...) do{\
+    if((level)<=PP_CONCAT(prefix,print_level)) PP_CONCAT(prefix,function)(__VA_ARGS__);\
+  }while(0)
+#define PRINT_ERROR(prefix,function,...) PRINT_LOG(prefix,PRINT_LEVEL_ERROR,function,__VA_ARGS__)
+#define PRINT_WARN(prefix,function,...)  PRINT_LOG(prefix,PRINT_LEVEL_WARN ,function,__VA_ARGS__)
+#define PRINT_INFO(prefix,function,...)  PRINT_LOG(prefix,PRINT_LEVEL_INFO ,function,__VA_ARGS__)
+#define PRINT_DEBUG(prefix,function,...) PRINT_LOG(prefix,PRINT_LEVEL_DEBUG,function,__VA_ARGS__)
+#define PRINT_TRACE(prefix,function,...) PRINT_LOG(prefix,PRINT_LEVEL_TRACE,function,__VA_ARGS__)
+#endif
+
+#ifndef PRINT_LEVEL
+#define PRINT_LEVEL PRINT_LEVEL_ALL
+#endif
+
+#ifndef __PRINT_FMT__
+#define __PRINT_FMT__
+//integer to text core, shared by all instances
+//decimal digits are produced two at a time, values which fit in 32 bit never use 64 bit arithmetic
+//and 64 bit values are split in chunks of 8 digits with a multiply by reciprocal instead of a division
+//(on 32 bit targets a 64 bit division is a call to a slow software routine)
+
+static const char print_fmt_dec_pairs[200]={
+  '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+  '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+  '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+  '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+  '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+  '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+  '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+  '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+  '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+  '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+
+//high 64 bits of a 64x64 bit product
+static uint64_t print_fmt_umulh64(uint64_t a, uint64_t b){
+#ifdef __SIZEOF_INT128__
+  return (uint64_t)(((unsigned __int128)a*b)>>64);
+#else
+  const uint64_t a_lo=(uint32_t)a, a_hi=a>>32;
+  const uint64_t b_lo=(uint32_t)b, b_hi=b>>32;
+  const uint64_t p0=a_lo*b_lo, p1=a_lo*b_hi, p2=a_hi*b_lo, p3=a_hi*b_hi;
+  const uint64_t mid=(p0>>32)+(uint32_t)p1+(uint32_t)p2;
+  return p3+(p1>>32)+(p2>>32)+(mid>>32);
+#endif
+}
+//n/100 for any 32 bit n
+static uint32_t print_fmt_div100(uint32_t n){return (uint32_t)(((uint64_t)n*0x51EB851F)>>37);}
+//n/10^8 for any 64 bit n: (n/2^8)/390625
+static uint64_t print_fmt_div1e8(uint64_t n){return print_fmt_umulh64(n>>8,0xABCC77118461CEFDull)>>18;}
+
+//write the decimal digits of v before end, return pointer to the first digit
+static char*print_fmt_u32_dec(char*end, uint32_t v){
+  while(v>=100){
+    const uint32_t q=print_fmt_div100(v);
+    const uint32_t r=v-100*q;
+    end-=2;
+    end[0]=print_fmt_dec_pairs[2*r];
+    end[1]=print_fmt_dec_pairs[2*r+1];
+    v=q;
+  }
+  if(v>=10){
+    end-=2;
+    end[0]=print_fmt_dec_pairs[2*v];
+    end[1]=print_fmt_dec_pairs[2*v+1];
+  } else {
+    *--end='0'+v;
+  }
+  return end;
+}
+//same as print_fmt_u32_dec but always 8 digits (v<10^8)
+static char*print_fmt_u32_dec8(char*end, uint32_t v){
+  for(unsigned int i=0;i<4;i++){
+    const uint32_t q=print_fmt_div100(v);
+    const uint32_t r=v-100*q;
+    end-=2;
+    end[0]=print_fmt_dec_pairs[2*r];
+    end[1]=print_fmt_dec_pairs[2*r+1];
+    v=q;
+  }
+  return end;
+}
+static char*print_fmt_u64_dec(char*end, uint64_t v){
+  if(0==(v>>32)) return print_fmt_u32_dec(end,(uint32_t)v);
+  uint64_t q=print_fmt_div1e8(v);
+  end=print_fmt_u32_dec8(end,(uint32_t)(v-q*100000000));
+  if(q>>32){//more than 17 digits
+    const uint64_t q2=print_fmt_div1e8(q);
+    end=print_fmt_u32_dec8(end,(uint32_t)(q-q2*100000000));
+    q=q2;
+  }
+  return print_fmt_u32_dec(end,(uint32_t)q);
+}
+//hex digit pairs of each byte value, upper case
+static const char print_fmt_hex_pairs[512]={
+  '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9','0','A','0','B','0','C','0','D','0','E','0','F',
+  '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9','1','A','1','B','1','C','1','D','1','E','1','F',
+  '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9','2','A','2','B','2','C','2','D','2','E','2','F',
+  '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9','3','A','3','B','3','C','3','D','3','E','3','F',
+  '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9','4','A','4','B','4','C','4','D','4','E','4','F',
+  '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9','5','A','5','B','5','C','5','D','5','E','5','F',
+  '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9','6','A','6','B','6','C','6','D','6','E','6','F',
+  '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9','7','A','7','B','7','C','7','D','7','E','7','F',
+  '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9','8','A','8','B','8','C','8','D','8','E','8','F',
+  '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9','9','A','9','B','9','C','9','D','9','E','9','F',
+  'A','0','A','1','A','2','A','3','A','4','A','5','A','6','A','7','A','8','A','9','A','A','A','B','A','C','A','D','A','E','A','F',
+  'B','0','B','1','B','2','B','3','B','4','B','5','B','6','B','7','B','8','B','9','B','A','B','B','B','C','B','D','B','E','B','F',
+  'C','0','C','1','C','2','C','3','C','4','C','5','C','6','C','7','C','8','C','9','C','A','C','B','C','C','C','D','C','E','C','F',
+  'D','0','D','1','D','2','D','3','D','4','D','5','D','6','D','7','D','8','D','9','D','A','D','B','D','C','D','D','D','E','D','F',
+  'E','0','E','1','E','2','E','3','E','4','E','5','E','6','E','7','E','8','E','9','E','A','E','B','E','C','E','D','E','E','E','F',
+  'F','0','F','1','F','2','F','3','F','4','F','5','F','6','F','7','F','8','F','9','F','A','F','B','F','C','F','D','F','E','F','F',
+};
+//write the ndigits least significant hex digits of v in dst[0..ndigits-1], ndigits<=16
+//two digits per byte from the pair table, on 32 bit words as long as the high word is not needed
+static void print_fmt_hex(char*dst, uint64_t v, unsigned int ndigits){
+  char*p=dst+ndigits;
+  uint32_t w=(uint32_t)v;
+  unsigned int n=ndigits;
+  if(n>8){
+    for(unsigned int i=0;i<4;i++){
+      p-=2;
+      memcpy(p,print_fmt_hex_pairs+2*(w&0xFF),2);
+      w>>=8;
+    }
+    n-=8;
+    w=(uint32_t)(v>>32);
+  }
+  for(;n>1;n-=2){
+    p-=2;
+    memcpy(p,print_fmt_hex_pairs+2*(w&0xFF),2);
+    w>>=8;
+  }
+  if(n) p[-1]=print_fmt_hex_pairs[2*(w&0xF)+1];
+}
+#endif //__PRINT_FMT__
+
 #define ADD_PRINT_PREFIX(a) PP_CONCAT(PRINT_PREFIX,a)
 
+#define _print_level         ADD_PRINT_PREFIX(print_level        )
 #define _print_enabled       ADD_PRINT_PREFIX(print_enabled      )
 #define _print_cfg           ADD_PRINT_PREFIX(print_cfg          )
+#define _print_ring          ADD_PRINT_PREFIX(print_ring         )
+#define _print_ring_head     ADD_PRINT_PREFIX(print_ring_head    )
+#define _print_ring_tail     ADD_PRINT_PREFIX(print_ring_tail    )
+#define _print_ring_drops    ADD_PRINT_PREFIX(print_ring_drops   )
+#define _print_ring_commit   ADD_PRINT_PREFIX(print_ring_commit  )
+#define _print_ring_write    ADD_PRINT_PREFIX(print_ring_write   )
+#define _print_ring_drain    ADD_PRINT_PREFIX(print_ring_drain   )
+#define _print_ring_dropped  ADD_PRINT_PREFIX(print_ring_dropped )
+#define _print_bin_msgs      ADD_PRINT_PREFIX(print_bin_msgs     )
+#define _print_bin_kinds     ADD_PRINT_PREFIX(print_bin_kinds    )
+#define _print_bin_hashes    ADD_PRINT_PREFIX(print_bin_hashes   )
+#define _print_bin_format    ADD_PRINT_PREFIX(print_bin_format   )
+#define _print_bin_emit      ADD_PRINT_PREFIX(print_bin_emit     )
+#define _print_buf           ADD_PRINT_PREFIX(print_buf          )
+#define _print_buf_len       ADD_PRINT_PREFIX(print_buf_len      )
+#define _print_buf_long      ADD_PRINT_PREFIX(print_buf_long     )
+#define _print_flush         ADD_PRINT_PREFIX(print_flush        )
 #define _print               ADD_PRINT_PREFIX(print              )
 #define _print_uint_as_hex   ADD_PRINT_PREFIX(print_uint_as_hex  )
 #define _print_uint_as_dec   ADD_PRINT_PREFIX(print_uint_as_dec  )
+#define _print_hex_msg       ADD_PRINT_PREFIX(print_hex_msg      )
+#define _print_dec_msg       ADD_PRINT_PREFIX(print_dec_msg      )
 #define _println             ADD_PRINT_PREFIX(println            )
 #define _print8x             ADD_PRINT_PREFIX(print8x            )
 #define _println8x           ADD_PRINT_PREFIX(println8x          )
@@ -58,63 +255,278 @@
 #define _print_array32x_0xln ADD_PRINT_PREFIX(print_array32x_0xln)
 
 
+enum {_print_level = PRINT_LEVEL};
 static bool _print_enabled=1;
-static void _print_cfg(bool enable){_print_enabled=enable;}
 
+#ifdef PRINT_BINARY
+#include "print_bin.h"
+#if defined(PRINT_BUFFER_SIZE) || defined(PRINT_RING_SLOTS)
+  #error "PRINT_BINARY cannot be combined with PRINT_BUFFER_SIZE or PRINT_RING_SLOTS"
+#endif
+#ifndef PRINT_BINARY_FORMATS
+#define PRINT_BINARY_FORMATS 64
+#endif
+#if (PRINT_BINARY_FORMATS < 1) || (PRINT_BINARY_FORMATS > PRINT_BIN_ID_MAX+1) || (PRINT_BINARY_FORMATS & (PRINT_BINARY_FORMATS-1))
+  #error "PRINT_BINARY_FORMATS shall be a power of 2 not larger than 0x4000"
+#endif
+//open addressing table indexed by the addresses of the strings of a format, the id of a format is its index.
+//the content of the strings is not looked at once a format has an id, unless PRINT_BINARY_CHECK is defined:
+//then a hash of the content is kept too, and a buffer reused with another content
+//(sprintf in a local array) gets its format defined again under the same id, so the decoded text stays exact.
+static const char*_print_bin_msgs[PRINT_BINARY_FORMATS][3];
+static uint16_t _print_bin_kinds[PRINT_BINARY_FORMATS];//1+(kind<<8|arg), 0 for a free entry
+#ifdef PRINT_BINARY_CHECK
+static uint32_t _print_bin_hashes[PRINT_BINARY_FORMATS];
+#endif
+
+//send kind, arg and the 3 strings of a format
+static void _print_bin_format(unsigned int kind, unsigned int arg, const char*const msgs[3]){
+  const uint8_t rec[2]={kind,arg};
+  ADD_PRINT_PREFIX(print_bin_impl)(rec,sizeof(rec));
+  for(unsigned int i=0;i<3;i++){
+    const size_t len = msgs[i] ? strlen(msgs[i]) : 0;
+    uint8_t len_rec[10];
+    ADD_PRINT_PREFIX(print_bin_impl)(len_rec,print_bin_put_uint(len_rec,len));
+    if(len) ADD_PRINT_PREFIX(print_bin_impl)((const uint8_t*)msgs[i],len);
+  }
+}
+//send the record of one call: id of the format (defined on first use), payload and data
+static void _print_bin_emit(unsigned int kind, unsigned int arg, const char*msg1, const char*msg2, const char*sep,
+                            const uint8_t*payload, unsigned int payload_size, const void*data, size_t data_size){
+  const char*const msgs[3]={msg1,msg2,sep};
+  const uint16_t key = 1+((kind<<8)|arg);
+  const uintptr_t k = (uintptr_t)msg1 ^ ((uintptr_t)msg2*31) ^ ((uintptr_t)sep*961) ^ key;
+  uint32_t h = (uint32_t)k*2654435761u;
+  h ^= h>>15;
+#ifdef PRINT_BINARY_CHECK
+  //FNV-1a of the content of the 3 strings
+  uint32_t hash = 2166136261u;
+  for(unsigned int i=0;i<3;i++){
+    for(const char*c=msgs[i];c && *c;c++) hash = (hash^(uint8_t)*c)*16777619u;
+    hash = (hash^0xFF)*16777619u;
+  }
+#endif
+  int id=-1;
+  for(unsigned int i=0;i<PRINT_BINARY_FORMATS;i++){
+    const unsigned int j = (h+i) & (PRINT_BINARY_FORMATS-1);
+    const int is_free = 0==_print_bin_kinds[j];
+    if(!is_free && ((key!=_print_bin_kinds[j]) || (msg1!=_print_bin_msgs[j][0]) || (msg2!=_print_bin_msgs[j][1]) || (sep!=_print_bin_msgs[j][2]))) continue;
+    id=j;
+#ifdef PRINT_BINARY_CHECK
+    if(!is_free && (hash==_print_bin_hashes[j])) break;
+    _print_bin_hashes[j] = hash;
+#else
+    if(!is_free) break;
+#endif
+    //first use, or content changed since the definition
+    _print_bin_kinds[j] = key;
+    _print_bin_msgs[j][0] = msg1;
+    _print_bin_msgs[j][1] = msg2;
+    _print_bin_msgs[j][2] = sep;
+    const uint8_t rec[3]={PRINT_BIN_DEF,j,j>>8};
+    ADD_PRINT_PREFIX(print_bin_impl)(rec,sizeof(rec));
+    _print_bin_format(kind,arg,msgs);
+    break;
+  }
+  uint8_t rec[2+16];
+  unsigned int n=0;
+  if(id<0){//table full
+    rec[0]=PRINT_BIN_INLINE;
+    ADD_PRINT_PREFIX(print_bin_impl)(rec,1);
+    _print_bin_format(kind,arg,msgs);
+  } else if(id<0x80){
+    rec[n++]=id;
+  } else {
+    rec[n++]=0x80|(id>>8);
+    rec[n++]=id;
+  }
+  if(payload_size) memcpy(rec+n,payload,payload_size);
+  n+=payload_size;
+  ADD_PRINT_PREFIX(print_bin_impl)(rec,n);
+  if(data_size) ADD_PRINT_PREFIX(print_bin_impl)((const uint8_t*)data,data_size);
+}
+static void _print_flush(void){}
+static void _print(const char*msg){
+  if(!_print_enabled) return;
+  _print_bin_emit(PRINT_BIN_KIND_STR,0,msg,0,0,0,0,0,0);
+}
+#elif defined(PRINT_BUFFER_SIZE)
+#if PRINT_BUFFER_SIZE < 2
+  #error "PRINT_BUFFER_SIZE shall be at least 2"
+#endif
+#ifdef PRINT_RING_SLOTS
+#if (PRINT_RING_SLOTS < 2) || (PRINT_RING_SLOTS & (PRINT_RING_SLOTS-1))
+  #error "PRINT_RING_SLOTS shall be a power of 2"
+#endif
+#ifndef PRINT_RING_TLS
+#define PRINT_RING_TLS __thread
+#endif
+//bounded queue with one sequence number per slot:
+//slot i is free for claim number n when its sequence is n, it holds committed line n when its sequence is n+1.
+//sequences are stored relative to the slot index so that zero initialization is the empty ring.
+static struct {
+  size_t seq;
+  char line[PRINT_BUFFER_SIZE];
+} _print_ring[PRINT_RING_SLOTS];
+static size_t _print_ring_head=0;//next claim, shared by producers
+static size_t _print_ring_tail=0;//next line to drain, owned by the consumer
+static size_t _print_ring_drops=0;
+
+static void _print_ring_commit(const char*line, unsigned int len){
+  size_t pos = __atomic_load_n(&_print_ring_head,__ATOMIC_RELAXED);
+  size_t idx;
+  for(;;){
+    idx = pos & (PRINT_RING_SLOTS-1);
+    const size_t seq = __atomic_load_n(&_print_ring[idx].seq,__ATOMIC_ACQUIRE) + idx;
+    const intptr_t diff = (intptr_t)(seq - pos);
+    if(0==diff){
+      if(__atomic_compare_exchange_n(&_print_ring_head,&pos,pos+1,true,__ATOMIC_RELAXED,__ATOMIC_RELAXED)) break;
+    } else if(diff<0){//full
+      __atomic_fetch_add(&_print_ring_drops,1,__ATOMIC_RELAXED);
+      return;
+    } else {
+      pos = __atomic_load_n(&_print_ring_head,__ATOMIC_RELAXED);
+    }
+  }
+  memcpy(_print_ring[idx].line,line,len);
+  _print_ring[idx].line[len]=0;
+  __atomic_store_n(&_print_ring[idx].seq,pos+1-idx,__ATOMIC_RELEASE);
+}
+static void _print_ring_write(const char*msg){
+  const size_t len = strlen(msg);
+  if(0==len) return;
+  if(len>PRINT_BUFFER_SIZE-1){
+    __atomic_fetch_add(&_print_ring_drops,1,__ATOMIC_RELAXED);
+    return;
+  }
+  _print_ring_commit(msg,len);
+}
+//single consumer, returns the number of lines passed to print_impl
+static unsigned int _print_ring_drain(void){
+  unsigned int cnt=0;
+  for(;;){
+    const size_t pos = _print_ring_tail;
+    const size_t idx = pos & (PRINT_RING_SLOTS-1);
+    const size_t seq = __atomic_load_n(&_print_ring[idx].seq,__ATOMIC_ACQUIRE) + idx;
+    if(seq != pos+1) return cnt;
+    ADD_PRINT_PREFIX(print_impl)(_print_ring[idx].line);
+    __atomic_store_n(&_print_ring[idx].seq,pos+PRINT_RING_SLOTS-idx,__ATOMIC_RELEASE);
+    _print_ring_tail = pos+1;
+    cnt++;
+  }
+}
+static size_t _print_ring_dropped(void){return __atomic_load_n(&_print_ring_drops,__ATOMIC_RELAXED);}
+
+static PRINT_RING_TLS char _print_buf[PRINT_BUFFER_SIZE];
+static PRINT_RING_TLS unsigned int _print_buf_len=0;
+static PRINT_RING_TLS bool _print_buf_long=0;//skipping the rest of a line too long for a slot
+static void _print_flush(void){
+  if(0==_print_buf_len) return;
+  _print_ring_commit(_print_buf,_print_buf_len);
+  _print_buf_len=0;
+}
+#else
+static char _print_buf[PRINT_BUFFER_SIZE];
+static unsigned int _print_buf_len=0;
+static void _print_flush(void){
+  if(0==_print_buf_len) return;
+  _print_buf[_print_buf_len]=0;
+  _print_buf_len=0;
+  ADD_PRINT_PREFIX(print_impl)(_print_buf);
+}
+#endif
+static void _print(const char*msg){
+  if(!_print_enabled) return;
+  while(*msg){
+    const char c = *msg++;
+#ifdef PRINT_RING_SLOTS
+    if(_print_buf_long){
+      _print_buf_long = '\n'!=c;
+      continue;
+    }
+    if(PRINT_BUFFER_SIZE-1==_print_buf_len){//the line does not fit in a slot: drop it whole
+      _print_buf_len=0;
+      _print_buf_long = '\n'!=c;
+      __atomic_fetch_add(&_print_ring_drops,1,__ATOMIC_RELAXED);
+      continue;
+    }
+    _print_buf[_print_buf_len++] = c;
+    if('\n'==c) _print_flush();
+#else
+    _print_buf[_print_buf_len++] = c;
+    if(('\n'==c) || (PRINT_BUFFER_SIZE-1==_print_buf_len)) _print_flush();
+#endif
+  }
+}
+#else
+#ifdef PRINT_RING_SLOTS
+  #error "PRINT_RING_SLOTS requires PRINT_BUFFER_SIZE"
+#endif
+static void _print_flush(void){}
 static void _print(const char*msg){if(!_print_enabled) return;ADD_PRINT_PREFIX(print_impl)(msg);}
+#endif
+
+static void _print_cfg(bool enable){if(!enable) _print_flush();_print_enabled=enable;}
 
 
-static void _print_uint_as_hex(uint64_t num, unsigned int nhexdigits){
+//msg1, value, msg2: the body of all the number functions
+#ifdef PRINT_BINARY
+static void _print_hex_msg(const char*msg1, uint64_t num, unsigned int nhexdigits, const char*msg2){
   if(!_print_enabled) return;
-  const char hex[16]={'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
+  nhexdigits = nhexdigits < 16 ? nhexdigits : 16;
+  uint8_t payload[8];
+  const unsigned int n = (nhexdigits+1)/2;
+  for(unsigned int i=0;i<n;i++) payload[i] = num>>(8*i);
+  _print_bin_emit(PRINT_BIN_KIND_HEX,nhexdigits,msg1,msg2,0,payload,n,0,0);
+}
+
+static void _print_dec_msg(const char*msg1, uint64_t num, unsigned int ndecdigits, const char*msg2){
+  if(!_print_enabled) return;
+  uint8_t payload[10];
+  _print_bin_emit(PRINT_BIN_KIND_DEC,ndecdigits < 20 ? ndecdigits : 20,msg1,msg2,0,payload,print_bin_put_uint(payload,num),0,0);
+}
 
-  uint8_t car;
+static void _println(const char*msg){
+  if(!_print_enabled) return;
+  _print_bin_emit(PRINT_BIN_KIND_STR,0,msg,"\n",0,0,0,0,0);
+}
+#else
+static void _print_hex_msg(const char*msg1, uint64_t num, unsigned int nhexdigits, const char*msg2){
+  if(!_print_enabled) return;
+  if(msg1) _print(msg1);
   nhexdigits = nhexdigits < 16 ? nhexdigits : 16;
-  uint8_t i = nhexdigits;
   char str_num[17];
-  str_num[i] = 0;
-  while (i > 0){
-    --i;
-    car = num & 0xF;
-    str_num[i] = hex[car];
-    num >>= 4;
-  }
+  print_fmt_hex(str_num,num,nhexdigits);
+  str_num[nhexdigits] = 0;
   _print(str_num);
+  if(msg2) _print(msg2);
 }
 
-static void _print_uint_as_dec(uint64_t num, unsigned int ndecdigits){
+static void _print_dec_msg(const char*msg1, uint64_t num, unsigned int ndecdigits, const char*msg2){
   if(!_print_enabled) return;
+  if(msg1) _print(msg1);
   char res[21];
   char* resptr = &res[20];
   *resptr=0;
-  uint64_t t=num;
-  unsigned int l=0;
-  char zero='0';
-  do{
-    uint64_t d=t/10;
-    uint64_t m=t-10*d;
-    *--resptr = zero+m;
-    l++;
-    zero=d ? zero : ' ';//replace leading zeroes by blank
-    t=d;
-  } while (t!=0);
-  while(l<ndecdigits){
-      *--resptr = ' ';
-      l++;
-  }
+  resptr = print_fmt_u64_dec(resptr,num);
+  const char*const first = ndecdigits < 20 ? &res[20-ndecdigits] : res;
+  while(resptr>first) *--resptr = ' ';//pad with blanks
   _print(resptr);
+  if(msg2) _print(msg2);
 }
 
 static void _println(const char*msg){
   if(!_print_enabled) return;
   _print(msg);_print("\n");
 }
+#endif
+
+static void _print_uint_as_hex(uint64_t num, unsigned int nhexdigits){_print_hex_msg(0,num,nhexdigits,0);}
+static void _print_uint_as_dec(uint64_t num, unsigned int ndecdigits){_print_dec_msg(0,num,ndecdigits,0);}
 
 static void _print8x(const char*msg1,uint8_t val,const char*msg2){
   if(!_print_enabled) return;
-  if(msg1) _print(msg1);
-  _print_uint_as_hex(val,2);
-  if(msg2) _print(msg2);
+  _print_hex_msg(msg1,val,2,msg2);
 }
 static void _println8x(const char*msg1,uint8_t val){
   if(!_print_enabled) return;
@@ -123,9 +535,7 @@ static void _println8x(const char*msg1,uint8_t val){
 
 static void _print8d(const char*msg1,uint32_t val,const char*msg2){
   if(!_print_enabled) return;
-  if(msg1) _print(msg1);
-  _print_uint_as_dec(val,3);
-  if(msg2) _print(msg2);
+  _print_dec_msg(msg1,val,3,msg2);
 }
 static void _println8d(const char*msg1,uint32_t val){
   if(!_print_enabled) return;
@@ -135,9 +545,7 @@ static void _println8d(const char*msg1,uint32_t val){
 
 static void _print16x(const char*msg1,uint16_t val,const char*msg2){
   if(!_print_enabled) return;
-  if(msg1) _print(msg1);
-  _print_uint_as_hex(val,4);
-  if(msg2) _print(msg2);
+  _print_hex_msg(msg1,val,4,msg2);
 }
 static void _println16x(const char*msg1,uint16_t val){
   if(!_print_enabled) return;
@@ -146,9 +554,7 @@ static void _println16x(const char*msg1,uint16_t val){
 
 static void _print16d(const char*msg1,uint32_t val,const char*msg2){
   if(!_print_enabled) return;
-  if(msg1) _print(msg1);
-  _print_uint_as_dec(val,5);
-  if(msg2) _print(msg2);
+  _print_dec_msg(msg1,val,5,msg2);
 }
 static void _println16d(const char*msg1,uint32_t val){
   if(!_print_enabled) return;
@@ -158,9 +564,7 @@ static void _println16d(const char*msg1,uint32_t val){
 
 static void _print32x(const char*msg1,uint32_t val,const char*msg2){
   if(!_print_enabled) return;
-  if(msg1) _print(msg1);
-  _print_uint_as_hex(val,8);
-  if(msg2) _print(msg2);
+  _print_hex_msg(msg1,val,8,msg2);
 }
 static void _println32x(const char*msg1,uint32_t val){
   if(!_print_enabled) return;
@@ -169,9 +573,7 @@ static void _println32x(const char*msg1,uint32_t val){
 
 static void _print32d(const char*msg1,uint32_t val,const char*msg2){
   if(!_print_enabled) return;
-  if(msg1) _print(msg1);
-  _print_uint_as_dec(val,10);
-  if(msg2) _print(msg2);
+  _print_dec_msg(msg1,val,10,msg2);
 }
 static void _println32d(const char*msg1,uint32_t val){
   if(!_print_enabled) return;
@@ -180,9 +582,7 @@ static void _println32d(const char*msg1,uint32_t val){
 
 static void _print64x(const char*msg1,uint64_t val,const char*msg2){
   if(!_print_enabled) return;
-  if(msg1) _print(msg1);
-  _print_uint_as_hex(val,16);
-  if(msg2) _print(msg2);
+  _print_hex_msg(msg1,val,16,msg2);
 }
 static void _println64x(const char*msg1,uint64_t val){
   if(!_print_enabled) return;
@@ -191,15 +591,20 @@ static void _println64x(const char*msg1,uint64_t val){
 
 static void _print64d(const char*msg1,uint32_t val,const char*msg2){
   if(!_print_enabled) return;
-  if(msg1) _print(msg1);
-  _print_uint_as_dec(val,10);
-  if(msg2) _print(msg2);
+  _print_dec_msg(msg1,val,10,msg2);
 }
 static void _println64d(const char*msg1,uint32_t val){
   if(!_print_enabled) return;
   _print64d(msg1,val,"\n");
 }
 
+#ifdef PRINT_BINARY
+static void _print_bytes_sep(const char*msg1,const void*const buf,unsigned int size, const char*msg2, const char*const separator){
+  if(!_print_enabled) return;
+  uint8_t payload[10];
+  _print_bin_emit(PRINT_BIN_KIND_BYTES,0,msg1,msg2,separator,payload,print_bin_put_uint(payload,size),buf,size);
+}
+#else
 static void _print_bytes_sep(const char*msg1,const void*const buf,unsigned int size, const char*msg2, const char*const separator){
   if(!_print_enabled) return;
   const uint8_t*const buf8=(const uint8_t*const)buf;
@@ -211,6 +616,7 @@ static void _print_bytes_sep(const char*msg1,const void*const buf,unsigned int s
   }
   if(msg2) _print(msg2);
 }
+#endif
 
 static void _print_bytes(const char*msg1,const void*const buf,unsigned int size, const char*msg2){
   if(!_print_enabled) return;
@@ -223,8 +629,13 @@ static void _println_bytes(const char*msg1,const void*const buf,unsigned int siz
 
 static void _print_bytes_0x(const char*msg1,const void*const buf,unsigned int size, const char*msg2){
   if(!_print_enabled) return;
+#ifdef PRINT_BINARY
+  uint8_t payload[10];
+  _print_bin_emit(PRINT_BIN_KIND_BYTES,PRINT_BIN_BYTES_0X,msg1,msg2,",0x",payload,print_bin_put_uint(payload,size),buf,size);
+#else
   _print(msg1);
   _print_bytes_sep("0x",buf,size,msg2,",0x");
+#endif
 }
 static void _println_bytes_0x(const char*msg1,const void*const buf,unsigned int size){
   if(!_print_enabled) return;
@@ -250,11 +661,31 @@ static void _print_array32x_0xln(const void*const buf, unsigned int n_elements){
 //  }while(0)
 
 
+#undef _print_level
 #undef _print_enabled
 #undef _print_cfg
+#undef _print_ring
+#undef _print_ring_head
+#undef _print_ring_tail
+#undef _print_ring_drops
+#undef _print_ring_commit
+#undef _print_ring_write
+#undef _print_ring_drain
+#undef _print_ring_dropped
+#undef _print_bin_msgs
+#undef _print_bin_kinds
+#undef _print_bin_hashes
+#undef _print_bin_format
+#undef _print_bin_emit
+#undef _print_buf
+#undef _print_buf_len
+#undef _print_buf_long
+#undef _print_flush
 #undef _print
 #undef _print_uint_as_hex
 #undef _print_uint_as_dec
+#undef _print_hex_msg
+#undef _print_dec_msg
 #undef _println
 #undef _print8x
 #undef _println8x
@@ -281,3 +712,9 @@ static void _print_array32x_0xln(const void*const buf, unsigned int n_elements){
 
 #undef ADD_PRINT_PREFIX
 #undef PRINT_PREFIX
+#undef PRINT_BUFFER_SIZE
+#undef PRINT_RING_SLOTS
+#undef PRINT_BINARY
+#undef PRINT_BINARY_FORMATS
+#undef PRINT_BINARY_CHECK
+#undef PRINT_LEVEL
@@ -0,0 +1,46 @@
+#ifndef __PRINT_BIN_H__
+#define __PRINT_BIN_H__
+//record format of print.h binary mode (PRINT_BINARY), decoded by print_decode.h
+//
+//each call of a print function is one record: the id of its format followed by the raw value.
+//a format is the kind of value, its digits/width and up to 3 strings (msg1, msg2, separator),
+//it is defined once with a PRINT_BIN_DEF record and then referenced by id.
+//
+//  0x00..0x7F                 id (0..0x7F) payload
+//  0x80..0xBF id_lo:u8        id (0x80..0x3FFF, high bits in the first byte) payload
+//  PRINT_BIN_DEF    id:u16 format                       define format id, nothing is printed
+//  PRINT_BIN_INLINE format payload                      print a format which has no id
+//
+//  format:  kind:u8 arg:u8 len1 msg1[len1] len2 msg2[len2] len3 sep[len3]
+//  lengths, sizes and decimal values are LEB128 (7 bits per byte, least significant first), u16 is little endian
+//
+//  kind                 arg                 payload             prints
+//  PRINT_BIN_KIND_STR   0                   -                   msg1 msg2
+//  PRINT_BIN_KIND_HEX   ndigits             value[(arg+1)/2]    msg1, arg hex digits (upper case, zero padded), msg2
+//  PRINT_BIN_KIND_DEC   width               value (LEB128)      msg1, value in decimal padded with blanks to arg, msg2
+//  PRINT_BIN_KIND_BYTES PRINT_BIN_BYTES_0X  size bytes[size]    msg1, "0x" if arg is PRINT_BIN_BYTES_0X,
+//                       or 0                                    hex digit pairs separated by sep, msg2
+
+#define PRINT_BIN_ID_MAX     0x3FFF
+#define PRINT_BIN_DEF        0xC0
+#define PRINT_BIN_INLINE     0xC1
+
+#define PRINT_BIN_KIND_STR   0
+#define PRINT_BIN_KIND_HEX   1
+#define PRINT_BIN_KIND_DEC   2
+#define PRINT_BIN_KIND_BYTES 3
+
+#define PRINT_BIN_BYTES_0X   1
+
+//write v as LEB128 in dst (up to 10 bytes), return the number of bytes written
+static unsigned int print_bin_put_uint(uint8_t*dst, uint64_t v){
+  unsigned int n=0;
+  while(v>=0x80){
+    dst[n++] = (uint8_t)v|0x80;
+    v>>=7;
+  }
+  dst[n++] = (uint8_t)v;
+  return n;
+}
+
+#endif //__PRINT_BIN_H__
@@ -0,0 +1,216 @@
+#ifndef __PRINT_DECODE_H__
+#define __PRINT_DECODE_H__
+//host side decoder for print.h binary mode (PRINT_BINARY)
+//turns records back into the text printed by the normal mode
+//
+//usage:
+//  print_decode_t d;
+//  print_decode_init(&d,out,ctx);
+//  print_decode(&d,data,size,&consumed);//as many times as needed, see below
+//  print_decode_free(&d);
+//
+//data does not need to end on a record boundary: the bytes of an incomplete last record are not consumed
+//and shall be passed again, followed by the next data.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "print_bin.h"
+
+typedef void (*print_decode_out_t)(void*ctx, const char*text, size_t len);
+
+//a format defined by the records, strings are NUL terminated copies
+typedef struct print_decode_fmt_struct {
+    uint8_t kind;
+    uint8_t arg;
+    char *msgs[3];
+    size_t lens[3];
+} print_decode_fmt_t;
+
+typedef struct print_decode_struct {
+    print_decode_fmt_t *fmts;//PRINT_BIN_ID_MAX+1 entries, kind and arg of undefined formats are 0xFF
+    print_decode_out_t out;
+    void *ctx;
+} print_decode_t;
+
+static int print_decode_init(print_decode_t *d, print_decode_out_t out, void *ctx){
+    d->fmts = (print_decode_fmt_t*)calloc(PRINT_BIN_ID_MAX+1,sizeof(print_decode_fmt_t));
+    d->out = out;
+    d->ctx = ctx;
+    if(0==d->fmts) return -1;
+    for(unsigned int i=0;i<=PRINT_BIN_ID_MAX;i++) d->fmts[i].kind = d->fmts[i].arg = 0xFF;
+    return 0;
+}
+
+static void print_decode_free(print_decode_t *d){
+    if(0==d->fmts) return;
+    for(unsigned int i=0;i<=PRINT_BIN_ID_MAX;i++){
+        for(unsigned int j=0;j<3;j++) free(d->fmts[i].msgs[j]);
+    }
+    free(d->fmts);
+    d->fmts = 0;
+}
+
+//read a LEB128 value, return its size, 0 if incomplete, -1 if longer than 64 bits
+static int print_decode_uint(const uint8_t *p, size_t avail, uint64_t *v){
+    *v=0;
+    for(unsigned int i=0;i<10;i++){
+        if(i==avail) return 0;
+        *v |= (uint64_t)(p[i]&0x7F)<<(7*i);
+        if(0==(p[i]&0x80)) return i+1;
+    }
+    return -1;
+}
+
+static void print_decode_hex_bytes(print_decode_t *d, const uint8_t *buf, uint64_t size, const char *sep, size_t sep_len){
+    static const char hex[16]={'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
+    char tmp[4096];
+    size_t n=0;
+    for(uint64_t i=0;i<size;i++){
+        if(n+2+sep_len>sizeof(tmp)){
+            d->out(d->ctx,tmp,n);
+            n=0;
+        }
+        if(i){
+            if(sep_len>sizeof(tmp)-2) d->out(d->ctx,sep,sep_len);
+            else {
+                memcpy(tmp+n,sep,sep_len);
+                n+=sep_len;
+            }
+        }
+        tmp[n++]=hex[buf[i]>>4];
+        tmp[n++]=hex[buf[i]&0xF];
+    }
+    if(n) d->out(d->ctx,tmp,n);
+}
+
+//parse a format at p into f, the strings point into p (not NUL terminated)
+//return its size, 0 if incomplete, -1 if malformed
+static long print_decode_format(const uint8_t *p, size_t avail, print_decode_fmt_t *f, const char *msgs[3]){
+    if(avail<2) return 0;
+    f->kind = p[0];
+    f->arg = p[1];
+    if((f->kind>PRINT_BIN_KIND_BYTES) || ((PRINT_BIN_KIND_HEX==f->kind) && (f->arg>16)) || ((PRINT_BIN_KIND_DEC==f->kind) && (f->arg>20))) return -1;
+    size_t len=2;
+    for(unsigned int i=0;i<3;i++){
+        uint64_t n;
+        const int s = print_decode_uint(p+len,avail-len,&n);
+        if(s<=0) return s;
+        len += s;
+        if(avail-len<n) return 0;
+        msgs[i] = (const char*)p+len;
+        f->lens[i] = n;
+        len += n;
+    }
+    return len;
+}
+
+#define PRINT_DECODE_MORE (-2)
+//parse the payload at p and print it with format f
+//return its size, PRINT_DECODE_MORE if incomplete (nothing is printed), -1 if malformed
+static long print_decode_payload(print_decode_t *d, const uint8_t *p, size_t avail, const print_decode_fmt_t *f, const char *const msgs[3]){
+    char tmp[32];
+    uint64_t v=0;
+    long len;
+    if(PRINT_BIN_KIND_STR==f->kind){
+        len = 0;
+    } else if(PRINT_BIN_KIND_HEX==f->kind){
+        len = (f->arg+1)/2;
+        if(avail<(size_t)len) return PRINT_DECODE_MORE;
+        for(long i=0;i<len;i++) v |= (uint64_t)p[i]<<(8*i);
+        if(f->arg<16) v &= (1ull<<(4*f->arg))-1;
+    } else {
+        len = print_decode_uint(p,avail,&v);
+        if(len<=0) return len<0 ? -1 : PRINT_DECODE_MORE;
+        if(PRINT_BIN_KIND_BYTES==f->kind){
+            if(avail-len<v) return PRINT_DECODE_MORE;
+            len += v;
+        }
+    }
+    if(f->lens[0]) d->out(d->ctx,msgs[0],f->lens[0]);
+    if((PRINT_BIN_KIND_HEX==f->kind) && f->arg) d->out(d->ctx,tmp,sprintf(tmp,"%0*llX",f->arg,(unsigned long long)v));
+    if(PRINT_BIN_KIND_DEC==f->kind) d->out(d->ctx,tmp,sprintf(tmp,"%*llu",f->arg,(unsigned long long)v));
+    if(PRINT_BIN_KIND_BYTES==f->kind){
+        if(PRINT_BIN_BYTES_0X==f->arg) d->out(d->ctx,"0x",2);
+        print_decode_hex_bytes(d,p+len-v,v,msgs[2],f->lens[2]);
+    }
+    if(f->lens[1]) d->out(d->ctx,msgs[1],f->lens[1]);
+    return len;
+}
+
+//decode the complete records of data, set *consumed to the number of bytes decoded
+//return 0 on success, -1 on malformed data (consumed is the offset of the bad record)
+static int print_decode(print_decode_t *d, const uint8_t *data, size_t size, size_t *consumed){
+    size_t pos=0;
+    int status=0;
+    while(pos<size){
+        const uint8_t *rec = data+pos;
+        const size_t avail = size-pos;
+        long len;
+        if(rec[0]<0xC0){//id and payload
+            unsigned int id = rec[0];
+            size_t id_len = 1;
+            if(id>=0x80){
+                if(avail<2) break;
+                id = ((id&0x3F)<<8) | rec[1];
+                id_len = 2;
+            }
+            const print_decode_fmt_t *f = d->fmts+id;
+            if(0xFF==f->kind){status=-1;break;}
+            len = print_decode_payload(d,rec+id_len,avail-id_len,f,(const char*const*)f->msgs);
+            if(PRINT_DECODE_MORE==len) break;
+            if(len>=0) len += id_len;
+        } else if(PRINT_BIN_DEF==rec[0]){
+            if(avail<3) break;
+            const unsigned int id = rec[1] | (rec[2]<<8);
+            if(id>PRINT_BIN_ID_MAX){status=-1;break;}
+            print_decode_fmt_t f;
+            const char *msgs[3];
+            len = print_decode_format(rec+3,avail-3,&f,msgs);
+            if(len>0){
+                print_decode_fmt_t *const def = d->fmts+id;
+                for(unsigned int i=0;i<3;i++){
+                    free(def->msgs[i]);
+                    def->msgs[i] = (char*)malloc(f.lens[i]+1);
+                    if(def->msgs[i]){
+                        memcpy(def->msgs[i],msgs[i],f.lens[i]);
+                        def->msgs[i][f.lens[i]] = 0;
+                    }
+                    def->lens[i] = f.lens[i];
+                }
+                def->kind = f.kind;
+                def->arg = f.arg;
+                if((0==def->msgs[0]) || (0==def->msgs[1]) || (0==def->msgs[2])){
+                    def->kind = 0xFF;
+                    status=-1;
+                    break;
+                }
+                len += 3;
+            } else if(0==len) break;
+        } else if(PRINT_BIN_INLINE==rec[0]){
+            print_decode_fmt_t f;
+            const char *msgs[3];
+            len = print_decode_format(rec+1,avail-1,&f,msgs);
+            if(len>0){
+                const long payload = print_decode_payload(d,rec+1+len,avail-1-len,&f,msgs);
+                if(PRINT_DECODE_MORE==payload) break;
+                len = payload<0 ? payload : 1+len+payload;
+            } else if(0==len) break;
+        } else {
+            len = -1;
+        }
+        if(len<0){
+            status=-1;
+            break;
+        }
+        pos += len;
+    }
+    *consumed = pos;
+    return status;
+}
+
+#undef PRINT_DECODE_MORE
+
+#endif //__PRINT_DECODE_H__
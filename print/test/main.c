@@ -1,4 +1,8 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
 
 #define PRINT_PREFIX uart0_
 static void uart0_print_impl(const char*msg){
@@ -18,6 +22,290 @@ static void uart1_print_impl(const char*msg){
 }
 #include "print.h"
 
+//unbuffered reference and buffered instance capturing their output
+static char ref_out[4096];
+static unsigned int ref_calls;
+#define PRINT_PREFIX ref_
+static void ref_print_impl(const char*msg){
+  strcat(ref_out,msg);
+  ref_calls++;
+}
+#include "print.h"
+
+static char buf_out[4096];
+static unsigned int buf_calls;
+#define PRINT_PREFIX buf_
+#define PRINT_BUFFER_SIZE 64
+static void buf_print_impl(const char*msg){
+  assert(strlen(msg)<64);
+  strcat(buf_out,msg);
+  buf_calls++;
+}
+#include "print.h"
+
+//check integer formatting against printf
+static char fmt_out[64];
+#define PRINT_PREFIX fmt_
+static void fmt_print_impl(const char*msg){strcat(fmt_out,msg);}
+#include "print.h"
+
+static void fmt_check(uint64_t v){
+  char expected[64];
+  for(unsigned int n=0;n<=20;n++){
+    fmt_out[0]=0;
+    fmt_print_uint_as_dec(v,n);
+    sprintf(expected,"%*llu",n,(unsigned long long)v);
+    assert(0==strcmp(expected,fmt_out));
+    fmt_out[0]=0;
+    fmt_print_uint_as_hex(v,n);
+    const unsigned int nh = n<16 ? n : 16;
+    const uint64_t mask = nh<16 ? (1ull<<(4*nh))-1 : ~0ull;
+    if(nh) sprintf(expected,"%0*llX",nh,(unsigned long long)(v&mask)); else expected[0]=0;
+    assert(0==strcmp(expected,fmt_out));
+  }
+}
+static void fmt_test(void){
+  uint64_t p10=1;
+  for(unsigned int i=0;i<20;i++){
+    fmt_check(p10-1);fmt_check(p10);fmt_check(p10+1);
+    fmt_check(p10*7+3);
+    p10*=10;
+  }
+  for(unsigned int i=0;i<64;i++){
+    fmt_check(1ull<<i);fmt_check((1ull<<i)-1);fmt_check(~0ull>>i);
+  }
+  uint64_t x=0x0123456789ABCDEFull;
+  for(unsigned int i=0;i<100000;i++){//xorshift
+    x^=x<<13;x^=x>>7;x^=x<<17;
+    fmt_check(x);fmt_check(x>>(i%64));
+  }
+}
+
+//binary mode: same calls on a text instance and a binary instance, decoded output shall match
+static char txt_out[8192];
+#define PRINT_PREFIX txt_
+static void txt_print_impl(const char*msg){strcat(txt_out,msg);}
+#include "print.h"
+
+//default format table
+static uint8_t bin_out[8192];
+static unsigned int bin_size;
+#define PRINT_PREFIX bin_
+#define PRINT_BINARY
+static void bin_print_bin_impl(const uint8_t*rec, unsigned int size){
+  assert(bin_size+size<=sizeof(bin_out));
+  memcpy(bin_out+bin_size,rec,size);
+  bin_size+=size;
+}
+#include "print.h"
+
+//small format table: most formats are sent inline with each call
+static uint8_t bin4_out[16384];
+static unsigned int bin4_size;
+#define PRINT_PREFIX bin4_
+#define PRINT_BINARY
+#define PRINT_BINARY_FORMATS 4
+static void bin4_print_bin_impl(const uint8_t*rec, unsigned int size){
+  assert(bin4_size+size<=sizeof(bin4_out));
+  memcpy(bin4_out+bin4_size,rec,size);
+  bin4_size+=size;
+}
+#include "print.h"
+
+//content check: buffers reused with another content are defined again
+static uint8_t bin2_out[1024];
+static unsigned int bin2_size;
+#define PRINT_PREFIX bin2_
+#define PRINT_BINARY
+#define PRINT_BINARY_CHECK
+static void bin2_print_bin_impl(const uint8_t*rec, unsigned int size){
+  assert(bin2_size+size<=sizeof(bin2_out));
+  memcpy(bin2_out+bin2_size,rec,size);
+  bin2_size+=size;
+}
+#include "print.h"
+
+#include "print_decode.h"
+static char dec_out[8192];
+static void dec_out_impl(void*ctx, const char*text, size_t len){
+  (void)ctx;
+  strncat(dec_out,text,len);
+}
+
+#define LOG_SEQUENCE(P) do{\
+  P##println("hello");\
+  for(unsigned int i=0;i<16;i++){\
+    P##println8x("i=0x",i);\
+    P##println32d("i*1000003=",i*1000003u);\
+    P##print16x("",i*0x111,"; ");\
+    P##println64x("x=0x",0x0123456789ABCDEFull<<i);\
+  }\
+  P##println_bytes("big: ",big,sizeof(big));\
+  P##println_bytes_0x("bytes: ",dat,sizeof(dat));\
+  P##print_bytes_sep("",big,7,"\n",0);\
+  P##print_uint_as_hex(0x12345,5);P##print_uint_as_dec(~0ull,20);\
+  P##print_array32x_0xln(dat,sizeof(dat)/4);\
+}while(0)
+
+//decode in chunks which are not aligned on records, the text shall match txt_out
+static void bin_decode_check(const uint8_t*bin, unsigned int size){
+  dec_out[0]=0;
+  print_decode_t d;
+  const int init_status = print_decode_init(&d,dec_out_impl,0);
+  assert(0==init_status);
+  size_t pos=0;
+  for(unsigned int i=0;i<size;i+=13){
+    const unsigned int end = i+13<size ? i+13 : size;
+    size_t consumed;
+    const int status = print_decode(&d,bin+pos,end-pos,&consumed);
+    assert(0==status);
+    pos+=consumed;
+  }
+  assert(pos==size);
+  print_decode_free(&d);
+  assert(0==strcmp(txt_out,dec_out));
+}
+
+static void bin_test(void){
+  uint32_t dat[] = {0,1,2,0xFFFFFFFF};
+  uint8_t big[100];
+  for(unsigned int i=0;i<sizeof(big);i++) big[i]=i*7;
+  LOG_SEQUENCE(txt_);
+  LOG_SEQUENCE(bin_);
+  LOG_SEQUENCE(bin4_);
+  bin_decode_check(bin_out,bin_size);
+  bin_decode_check(bin4_out,bin4_size);
+  const unsigned int txt_size = strlen(txt_out);
+  printf("binary: %u bytes instead of %u (%u with 4 formats)\n",bin_size,txt_size,bin4_size);
+  assert(2*bin_size<txt_size);
+  //one record per call: the id and the 4 bytes of the value once the format is defined
+  txt_out[0]=0;
+  const unsigned int def_size = bin_size;
+  for(unsigned int i=0;i<100;i++){
+    txt_println32x("x=0x",i*0x01010101u);
+    bin_println32x("x=0x",i*0x01010101u);
+  }
+  const unsigned int rec_size = bin_size-def_size;
+  assert(5*100+16>=rec_size);//+ the definition of the format
+  assert(2*rec_size<strlen(txt_out));
+}
+
+//a buffer reused with another content (same address) is decoded with its current content
+static void bin_reuse_test(void){
+  char name[16];
+  for(unsigned int i=0;i<3;i++){
+    sprintf(name,"item%u",i);
+    bin2_println(name);
+    bin2_println(name);
+  }
+  strcpy(name,"x");
+  bin2_println(name);
+  dec_out[0]=0;
+  print_decode_t d;
+  const int init_status = print_decode_init(&d,dec_out_impl,0);
+  assert(0==init_status);
+  size_t consumed;
+  const int status = print_decode(&d,bin2_out,bin2_size,&consumed);
+  assert(0==status);
+  assert(consumed==bin2_size);
+  print_decode_free(&d);
+  assert(0==strcmp(dec_out,"item0\nitem0\nitem1\nitem1\nitem2\nitem2\nx\n"));
+}
+
+//compile time level: calls above PRINT_LEVEL_WARN are removed with their arguments
+static char lvl_out[256];
+#define PRINT_PREFIX lvl_
+#define PRINT_LEVEL PRINT_LEVEL_WARN
+static void lvl_print_impl(const char*msg){strcat(lvl_out,msg);}
+#include "print.h"
+
+static void lvl_test(void){
+  unsigned int evaluated=0;
+  PRINT_ERROR(lvl_,println32d,"error ",++evaluated);
+  PRINT_WARN(lvl_,println32x,"warn 0x",++evaluated);
+  PRINT_INFO(lvl_,println32d,"info ",++evaluated);
+  PRINT_DEBUG(lvl_,println_bytes,"debug ",&evaluated,++evaluated);
+  PRINT_TRACE(lvl_,println,(++evaluated,"trace"));
+  lvl_print_cfg(0);
+  PRINT_ERROR(lvl_,println,"disabled at runtime");
+  lvl_print_cfg(1);
+  assert(2==evaluated);
+  assert(0==strcmp(lvl_out,"error          1\nwarn 0x00000002\n"));
+  //ref_ has the default level, PRINT_LEVEL_ALL
+  PRINT_TRACE(ref_,println,"trace on ref");
+  assert(0==strcmp(ref_out+strlen(ref_out)-13,"trace on ref\n"));
+}
+
+//ring instance: several producer threads, one consumer thread
+#define RING_PRODUCERS 4
+#define RING_LINES     20000
+#define RING_SLOTS     16
+static unsigned int ring_received;
+static uint32_t ring_next[RING_PRODUCERS];
+#define PRINT_PREFIX ring_
+#define PRINT_BUFFER_SIZE 64
+#define PRINT_RING_SLOTS RING_SLOTS
+static void ring_print_impl(const char*msg){
+  unsigned int t,i;
+  char end;
+  //each line shall be committed whole
+  const int fields = sscanf(msg,"thread %u line 0x%x%c",&t,&i,&end);
+  assert(3==fields);
+  if(3!=fields) return;
+  assert('\n'==end);
+  assert(t<RING_PRODUCERS);
+  assert(i>=ring_next[t]);//lines from one producer are kept in order
+  ring_next[t]=i+1;
+  ring_received++;
+}
+#include "print.h"
+
+static void *ring_producer(void*arg){
+  const uint32_t t = (uint32_t)(uintptr_t)arg;
+  for(uint32_t i=0;i<RING_LINES;i++){
+    ring_print32d("thread ",t,"");
+    ring_println32x(" line 0x",i);
+    if(0==(i%4)) sched_yield();//let the consumer run on machines with few cores
+  }
+  return 0;
+}
+static volatile int ring_done;
+static void *ring_consumer(void*arg){
+  (void)arg;
+  while(!ring_done) if(0==ring_print_ring_drain()) sched_yield();
+  ring_print_ring_drain();
+  return 0;
+}
+static void ring_test(void){
+  pthread_t producers[RING_PRODUCERS];
+  pthread_t consumer;
+  pthread_create(&consumer,0,ring_consumer,0);
+  for(uintptr_t t=0;t<RING_PRODUCERS;t++) pthread_create(&producers[t],0,ring_producer,(void*)t);
+  for(unsigned int t=0;t<RING_PRODUCERS;t++) pthread_join(producers[t],0);
+  ring_done=1;
+  pthread_join(consumer,0);
+  ring_print_ring_write("thread 0 line 0xFFFFFFFF\n");
+  const unsigned int drained = ring_print_ring_drain();
+  assert(1==drained);
+  const size_t dropped = ring_print_ring_dropped();
+  printf("ring: %u lines received, %u dropped\n",ring_received,(unsigned int)dropped);
+  assert(ring_received+dropped==RING_PRODUCERS*RING_LINES+1);
+  //how many lines get through the threads depends on the scheduling, a full ring is checked alone:
+  //it keeps RING_SLOTS lines and drops the next one
+  ring_next[2]=0;
+  for(uint32_t i=0;i<RING_SLOTS+1;i++) ring_println32x("thread 2 line 0x",i);
+  const unsigned int drained_full = ring_print_ring_drain();
+  assert(RING_SLOTS==drained_full);
+  assert(ring_print_ring_dropped()==dropped+1);
+  const size_t dropped_full = ring_print_ring_dropped();
+  //lines which do not fit in a slot are dropped whole, not split
+  ring_println("thread 1 line 0x1 is much too long to fit in a slot of sixty four characters");
+  ring_print_ring_write("thread 1 line 0x2 is much too long to fit in a slot of sixty four characters\n");
+  ring_println32x("thread 1 line 0x",0xFFFFFFFF);
+  const unsigned int drained_long = ring_print_ring_drain();
+  assert(1==drained_long);
+  assert(ring_print_ring_dropped()==dropped_full+2);
+}
 
 int main(void){
   uint32_t dat[] = {0,1,2,3};
@@ -27,4 +315,24 @@ int main(void){
   uart0_print_array32x_0xln(dat,sizeof(dat)/4);
   uart1_println_bytes_0x("bytes: ",dat,sizeof(dat));
   uart1_print_array32x_0xln(dat,sizeof(dat)/4);
+
+  uint8_t big[256];
+  for(unsigned int i=0;i<sizeof(big);i++) big[i]=i;
+  ref_println_bytes("big: ",big,sizeof(big));
+  ref_print_array32x_0xln(dat,sizeof(dat)/4);
+  ref_print32d("no newline ",12345,"");
+  buf_println_bytes("big: ",big,sizeof(big));
+  buf_print_array32x_0xln(dat,sizeof(dat)/4);
+  buf_print32d("no newline ",12345,"");
+  assert(strlen(buf_out)<strlen(ref_out));
+  buf_print_flush();
+  printf("buffered: %u print_impl calls instead of %u\n",buf_calls,ref_calls);
+  assert(0==strcmp(ref_out,buf_out));
+  assert(buf_calls<ref_calls/20);
+  fmt_test();
+  bin_test();
+  bin_reuse_test();
+  lvl_test();
+  ring_test();
+  printf("TEST PASS\n");
 }
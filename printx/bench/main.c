@@ -0,0 +1,115 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//benchmark of printx32_dump_buf32 against the former one printf per byte implementation
+//and of printx_hex_encode/printx_hex_decode against printx_bytes_to_hexstr/printx_hexstr_to_bytes
+//and of printx_hexparse_feed against printx_user_hexstr_to_bytes on a test vector file layout
+//and speed of printx32_diff_buf32 on buffers with a handful of differences
+//the dump goes to stdout, redirect it to /dev/null (see build)
+
+#include "printx.h"
+
+static void ref_dump_buf(const char *msg,const void*const buf,size_t size,uint32_t base, int bytes_per_word,int words_per_line){
+    const int bytes_per_line=bytes_per_word*words_per_line;
+    const uint8_t*pos=(const uint8_t*)buf;
+    printx_printf("%s",msg);
+    for(int i=0;i<size/bytes_per_line;i++){
+        printx_printf("%08x: ",base+(uint32_t)(uintptr_t)(pos-(const uint8_t*const)buf));
+        for(int j=0;j<words_per_line;j++) {
+            printx_bytes_sep("",pos,bytes_per_word," ","");
+            pos+=bytes_per_word;
+        }
+        printx_printf("\n");
+    }
+    const int remaining = size%bytes_per_line;
+    if(remaining){
+        printx_printf("%08x: ",base+(uint32_t)(uintptr_t)(pos-(const uint8_t*const)buf));
+        for(int j=0;j<remaining/bytes_per_word;j++) {
+            printx_bytes_sep("",pos,bytes_per_word," ","");
+            pos+=bytes_per_word;
+        }
+        if(remaining%bytes_per_word){
+            printx_bytes_sep("",pos,remaining%bytes_per_word," ","");
+        }
+        printx_printf("\n");
+    }
+}
+
+static double now_seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+int main(int argc, char *argv[]){
+    const size_t size = (argc>1 ? atol(argv[1]) : 16) << 20;
+    uint8_t *buf = (uint8_t*)malloc(size);
+    for(size_t i=0;i<size;i++) buf[i] = rand();
+    double start = now_seconds();
+    ref_dump_buf("",buf,size,0,4,16);
+    fflush(stdout);
+    const double ref = now_seconds()-start;
+    start = now_seconds();
+    printx32_dump_buf32("",buf,size,0);
+    fflush(stdout);
+    const double new = now_seconds()-start;
+    fprintf(stderr,"dump of %zu MiB: %.3fs before, %.3fs now, speedup %.1fx (%.0f MiB/s)\n",size>>20,ref,new,ref/new,(size>>20)/new);
+
+    char *hex = (char*)malloc(2*size+1);
+    uint8_t *dec = (uint8_t*)malloc(size);
+    start = now_seconds();
+    printx_bytes_to_hexstr(hex,buf,size);
+    const double ref_enc = now_seconds()-start;
+    start = now_seconds();
+    printx_hex_encode(hex,buf,size);
+    const double new_enc = now_seconds()-start;
+    fprintf(stderr,"hex encode: %8.1f MiB/s before, %8.1f MiB/s now\n",(size>>20)/ref_enc,(size>>20)/new_enc);
+    start = now_seconds();
+    printx_hexstr_to_bytes(dec,size,hex);
+    const double ref_dec = now_seconds()-start;
+    start = now_seconds();
+    size_t bad_pos;
+    if(printx_hex_decode(dec,hex,2*size,&bad_pos) || memcmp(dec,buf,size)) return 1;
+    const double new_dec = now_seconds()-start;
+    fprintf(stderr,"hex decode: %8.1f MiB/s before, %8.1f MiB/s now\n",(size>>20)/ref_dec,(size>>20)/new_dec);
+
+    //test vector layout: 32 bytes per line, read in 64 KiB chunks
+    const size_t text_size = 2*size + size/32;
+    char *text = (char*)malloc(text_size+1);
+    double ref_parse = 0;
+    for(unsigned int k=0;k<2;k++){//the reference clobbers the text, generate it again
+        for(size_t i=0,t=0;i<size;i+=32,t+=65){
+            printx_hex_encode(text+t,buf+i,32);
+            text[t+64] = '\n';
+        }
+        text[text_size] = 0;
+        if(k) break;
+        start = now_seconds();
+        printx_user_hexstr_to_bytes(dec,size,text,text_size+1);
+        ref_parse = now_seconds()-start;
+    }
+    memset(dec,0,size);
+    start = now_seconds();
+    printx_hexparse_t parser;
+    printx_hexparse_init(&parser,dec,size);
+    for(size_t t=0;t<text_size;t+=65536) printx_hexparse_feed(&parser,text+t,text_size-t < 65536 ? text_size-t : 65536);
+    if((size!=printx_hexparse_finish(&parser)) || memcmp(dec,buf,size)) return 1;
+    const double new_parse = now_seconds()-start;
+    fprintf(stderr,"hex parse:  %8.1f MiB/s before, %8.1f MiB/s now\n",(text_size>>20)/ref_parse,(text_size>>20)/new_parse);
+    free(text);
+
+    memcpy(dec,buf,size);
+    for(unsigned int i=0;i<5;i++) dec[rand()%size] ^= 0x80;
+    start = now_seconds();
+    const size_t n_diff = printx32_diff_buf32("",buf,dec,size,0,2);
+    fflush(stdout);
+    const double diff = now_seconds()-start;
+    fprintf(stderr,"diff of %zu MiB, %zu bytes differ: %.3fs (%.0f MiB/s)\n",size>>20,n_diff,diff,(size>>20)/diff);
+    free(hex);
+    free(dec);
+    free(buf);
+    (void)printx_remove_unused_warnings;
+    return 0;
+}
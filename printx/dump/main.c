@@ -0,0 +1,64 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//hex dump of a file of any size with 64 bit addresses, formatted in parallel
+//same line format as printx32_dump_buf32/printx32_dump_buf64
+
+#define printx_write(buf,len) fwrite((buf),1,(len),stdout)
+#define PRINTX_HAS_PTHREAD
+#include "printx.h"
+
+static void usage(const char *name){
+    fprintf(stderr,"usage: %s [-j threads] [-b base] [-w 4|8] file > dump\n",name);
+}
+
+int main(int argc, char *argv[]){
+    long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t base = 0;
+    size_t bytes_per_word = 4;
+    const char *path = 0;
+    for(int i=1;i<argc;i++){
+        if(0==strcmp(argv[i],"-j") && i+1<argc){
+            n_threads = atol(argv[++i]);
+        } else if(0==strcmp(argv[i],"-b") && i+1<argc){
+            base = strtoull(argv[++i],0,0);
+        } else if(0==strcmp(argv[i],"-w") && i+1<argc){
+            bytes_per_word = atol(argv[++i]);
+        } else if(0==path){
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if((0==path) || ((4!=bytes_per_word) && (8!=bytes_per_word))){
+        usage(argv[0]);
+        return 1;
+    }
+    if(n_threads<1) n_threads = 1;
+    const int fd = open(path,O_RDONLY);
+    struct stat st;
+    if((fd<0) || fstat(fd,&st)){
+        perror(path);
+        return 1;
+    }
+    const size_t size = st.st_size;
+    if(size){
+        void *map = mmap(0,size,PROT_READ,MAP_PRIVATE,fd,0);
+        if(MAP_FAILED==map){
+            perror(path);
+            return 1;
+        }
+        printx64_dump_buf_mt("",map,size,base,bytes_per_word,64/bytes_per_word,n_threads);
+        munmap(map,size);
+    }
+    close(fd);
+    (void)printx_remove_unused_warnings;
+    return fflush(stdout) ? 1 : 0;
+}
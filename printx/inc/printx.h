@@ -4,12 +4,46 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifndef printx_printf
 #define printx_printf printf
 #endif
 
+//output of preformatted text, one call per block
+#ifndef printx_write
+#define printx_write(buf,len) printx_printf("%.*s",(int)(len),(buf))
+#endif
+
+#ifndef PRINTX_DUMP_BLOCK_SIZE
+#define PRINTX_DUMP_BLOCK_SIZE 4096
+#endif
+
+//lines formatted per worker and per round by printx64_dump_buf_mt
+#ifndef PRINTX_DUMP_CHUNK_LINES
+#define PRINTX_DUMP_CHUNK_LINES 16384
+#endif
+
+//printx64_dump_buf_mt is available only if PRINTX_HAS_PTHREAD is defined (link with -pthread)
+#ifdef PRINTX_HAS_PTHREAD
+#include <pthread.h>
+#endif
+
+//SSE2/AVX2 versions of printx_hex_encode/printx_hex_decode are used when the compiler targets them
+#if !defined(PRINTX_NO_SIMD) && (defined(__SSE2__) || defined(__AVX2__))
+#include <immintrin.h>
+#endif
+
+#define PRINTX_HEX_ROW(h) h"0" h"1" h"2" h"3" h"4" h"5" h"6" h"7" h"8" h"9" h"A" h"B" h"C" h"D" h"E" h"F"
+//"000102...FF": upper case hex digits of each byte value
+static const char printx_hex_pairs[513] =
+    PRINTX_HEX_ROW("0") PRINTX_HEX_ROW("1") PRINTX_HEX_ROW("2") PRINTX_HEX_ROW("3")
+    PRINTX_HEX_ROW("4") PRINTX_HEX_ROW("5") PRINTX_HEX_ROW("6") PRINTX_HEX_ROW("7")
+    PRINTX_HEX_ROW("8") PRINTX_HEX_ROW("9") PRINTX_HEX_ROW("A") PRINTX_HEX_ROW("B")
+    PRINTX_HEX_ROW("C") PRINTX_HEX_ROW("D") PRINTX_HEX_ROW("E") PRINTX_HEX_ROW("F");
+#undef PRINTX_HEX_ROW
+
 //replace 0 by .
 static void printx_diff_byte(uint8_t d, const char *sep){
     unsigned int n=d>>4;
@@ -82,6 +116,130 @@ static void printx_bytes_to_hexstr(char *dst,uint8_t *bytes, unsigned int nBytes
 		sprintf(dst+2*i,"%02X",bytes[i]);
 	}
 }
+
+//table for printx_hex_decode: 1+value of each hex digit, 0 for other characters
+static const uint8_t printx_hex_values[256] = {
+    ['0']=1, ['1']=2, ['2']=3, ['3']=4, ['4']=5, ['5']=6, ['6']=7, ['7']=8, ['8']=9, ['9']=10,
+    ['A']=11,['B']=12,['C']=13,['D']=14,['E']=15,['F']=16,
+    ['a']=11,['b']=12,['c']=13,['d']=14,['e']=15,['f']=16,
+};
+
+//encode n bytes from src as 2*n upper case hex digits in dst, no null terminator is written
+//returns 2*n
+static size_t printx_hex_encode(char *dst, const void *src, size_t n){
+    const uint8_t *s = (const uint8_t*)src;
+    size_t i=0;
+#if !defined(PRINTX_NO_SIMD) && defined(__AVX2__)
+    {
+        const __m256i mask = _mm256_set1_epi8(0x0F);
+        const __m256i nine = _mm256_set1_epi8(9);
+        const __m256i ascii0 = _mm256_set1_epi8('0');
+        const __m256i letter = _mm256_set1_epi8('A'-'0'-10);
+        for(;i+32<=n;i+=32){
+            const __m256i v = _mm256_loadu_si256((const __m256i*)(s+i));
+            __m256i lo = _mm256_and_si256(v,mask);
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v,4),mask);
+            lo = _mm256_add_epi8(_mm256_add_epi8(lo,ascii0),_mm256_and_si256(_mm256_cmpgt_epi8(lo,nine),letter));
+            hi = _mm256_add_epi8(_mm256_add_epi8(hi,ascii0),_mm256_and_si256(_mm256_cmpgt_epi8(hi,nine),letter));
+            const __m256i a = _mm256_unpacklo_epi8(hi,lo);//bytes 0-7 and 16-23
+            const __m256i b = _mm256_unpackhi_epi8(hi,lo);//bytes 8-15 and 24-31
+            _mm256_storeu_si256((__m256i*)(dst+2*i),_mm256_permute2x128_si256(a,b,0x20));
+            _mm256_storeu_si256((__m256i*)(dst+2*i+32),_mm256_permute2x128_si256(a,b,0x31));
+        }
+    }
+#endif
+#if !defined(PRINTX_NO_SIMD) && defined(__SSE2__)
+    {
+        const __m128i mask = _mm_set1_epi8(0x0F);
+        const __m128i nine = _mm_set1_epi8(9);
+        const __m128i ascii0 = _mm_set1_epi8('0');
+        const __m128i letter = _mm_set1_epi8('A'-'0'-10);
+        for(;i+16<=n;i+=16){
+            const __m128i v = _mm_loadu_si128((const __m128i*)(s+i));
+            __m128i lo = _mm_and_si128(v,mask);
+            __m128i hi = _mm_and_si128(_mm_srli_epi16(v,4),mask);
+            lo = _mm_add_epi8(_mm_add_epi8(lo,ascii0),_mm_and_si128(_mm_cmpgt_epi8(lo,nine),letter));
+            hi = _mm_add_epi8(_mm_add_epi8(hi,ascii0),_mm_and_si128(_mm_cmpgt_epi8(hi,nine),letter));
+            _mm_storeu_si128((__m128i*)(dst+2*i),_mm_unpacklo_epi8(hi,lo));
+            _mm_storeu_si128((__m128i*)(dst+2*i+16),_mm_unpackhi_epi8(hi,lo));
+        }
+    }
+#endif
+    for(;i<n;i++) memcpy(dst+2*i,printx_hex_pairs+2*s[i],2);
+    return 2*n;
+}
+
+#if !defined(PRINTX_NO_SIMD) && defined(__SSE2__)
+//value of 16 hex digits, *valid gets one bit per valid digit
+static __m128i printx_hex_decode_sse2(__m128i c, int *valid){
+    const __m128i lc = _mm_or_si128(c,_mm_set1_epi8(0x20));
+    //signed compares: characters above 0x7F are negative and fail both ranges
+    const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(c,_mm_set1_epi8('0'-1)),_mm_cmpgt_epi8(_mm_set1_epi8('9'+1),c));
+    const __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lc,_mm_set1_epi8('a'-1)),_mm_cmpgt_epi8(_mm_set1_epi8('f'+1),lc));
+    *valid = _mm_movemask_epi8(_mm_or_si128(is_digit,is_alpha));
+    const __m128i digit = _mm_and_si128(is_digit,_mm_sub_epi8(c,_mm_set1_epi8('0')));
+    const __m128i alpha = _mm_and_si128(is_alpha,_mm_sub_epi8(lc,_mm_set1_epi8('a'-10)));
+    const __m128i v = _mm_or_si128(digit,alpha);
+    //16 bit lanes hold high nibble in low byte, low nibble in high byte
+    return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v,_mm_set1_epi16(0x00FF)),4),_mm_srli_epi16(v,8));
+}
+#endif
+#if !defined(PRINTX_NO_SIMD) && defined(__AVX2__)
+static __m256i printx_hex_decode_avx2(__m256i c, int *valid){
+    const __m256i lc = _mm256_or_si256(c,_mm256_set1_epi8(0x20));
+    const __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(c,_mm256_set1_epi8('0'-1)),_mm256_cmpgt_epi8(_mm256_set1_epi8('9'+1),c));
+    const __m256i is_alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lc,_mm256_set1_epi8('a'-1)),_mm256_cmpgt_epi8(_mm256_set1_epi8('f'+1),lc));
+    *valid = _mm256_movemask_epi8(_mm256_or_si256(is_digit,is_alpha));
+    const __m256i digit = _mm256_and_si256(is_digit,_mm256_sub_epi8(c,_mm256_set1_epi8('0')));
+    const __m256i alpha = _mm256_and_si256(is_alpha,_mm256_sub_epi8(lc,_mm256_set1_epi8('a'-10)));
+    const __m256i v = _mm256_or_si256(digit,alpha);
+    return _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(v,_mm256_set1_epi16(0x00FF)),4),_mm256_srli_epi16(v,8));
+}
+#endif
+
+//decode hex_len hex digits (upper or lower case) from hex into hex_len/2 bytes in dst
+//returns 0 on success
+//returns -1 if hex contains a character which is not a hex digit or if hex_len is odd:
+//*bad_pos is then the position of the first bad character (hex_len-1 for odd hex_len)
+//and dst holds the bytes decoded before it
+static int printx_hex_decode(uint8_t *dst, const char *hex, size_t hex_len, size_t *bad_pos){
+    const uint8_t *h = (const uint8_t*)hex;
+    const size_t n = hex_len/2;
+    size_t i=0;
+#if !defined(PRINTX_NO_SIMD) && defined(__AVX2__)
+    for(;i+32<=n;i+=32){
+        int valid0,valid1;
+        const __m256i a = printx_hex_decode_avx2(_mm256_loadu_si256((const __m256i*)(h+2*i)),&valid0);
+        const __m256i b = printx_hex_decode_avx2(_mm256_loadu_si256((const __m256i*)(h+2*i+32)),&valid1);
+        if((-1!=valid0) || (-1!=valid1)) break;//let the scalar loop find the bad digit
+        //packus works within 128 bit lanes, reorder the 64 bit quarters
+        _mm256_storeu_si256((__m256i*)(dst+i),_mm256_permute4x64_epi64(_mm256_packus_epi16(a,b),0xD8));
+    }
+#endif
+#if !defined(PRINTX_NO_SIMD) && defined(__SSE2__)
+    for(;i+16<=n;i+=16){
+        int valid0,valid1;
+        const __m128i a = printx_hex_decode_sse2(_mm_loadu_si128((const __m128i*)(h+2*i)),&valid0);
+        const __m128i b = printx_hex_decode_sse2(_mm_loadu_si128((const __m128i*)(h+2*i+16)),&valid1);
+        if((0xFFFF!=valid0) || (0xFFFF!=valid1)) break;
+        _mm_storeu_si128((__m128i*)(dst+i),_mm_packus_epi16(a,b));
+    }
+#endif
+    for(;i<n;i++){
+        const uint8_t hi = printx_hex_values[h[2*i]];
+        const uint8_t lo = printx_hex_values[h[2*i+1]];
+        if((0==hi) || (0==lo)){
+            *bad_pos = 0==hi ? 2*i : 2*i+1;
+            return -1;
+        }
+        dst[i] = ((hi-1)<<4) | (lo-1);
+    }
+    if(hex_len & 1){
+        *bad_pos = hex_len-1;
+        return -1;
+    }
+    return 0;
+}
 static size_t printx_cleanup_hexstr(char *hexstr, size_t hexstr_size, char *str, size_t str_size){
 	size_t cnt=0;
 	int lastIs0=0;
@@ -109,30 +267,150 @@ static size_t printx_user_hexstr_to_bytes(uint8_t*out, size_t out_size, char *st
 	return printx_hexstr_to_bytes(out,conv_size,str);
 }
 
-static void printx32_dump_buf(const char *msg,const void*const buf,size_t size,uint32_t base, int bytes_per_word,int words_per_line){
-    const int bytes_per_line=bytes_per_word*words_per_line;
-    const uint8_t*pos=(const uint8_t*)buf;
-    printx_printf("%s",msg);
-    for(int i=0;i<size/bytes_per_line;i++){
-        printx_printf("%08x: ",base+(uint32_t)(uintptr_t)(pos-(const uint8_t*const)buf));
-        for(int j=0;j<words_per_line;j++) {
-            printx_bytes_sep("",pos,bytes_per_word," ","");
-            pos+=bytes_per_word;
+//resumable parser, produces the same bytes as printx_user_hexstr_to_bytes
+//but in one pass over chunks of any size, without copying nor NUL termination:
+//non hex characters are separators, "0x"/"0X" prefixes are dropped
+typedef struct printx_hexparse_struct {
+    uint8_t *out;
+    size_t out_size;
+    size_t n;           //bytes decoded so far, only the first out_size are stored
+    int nibble;         //pending high nibble, -1 if none
+    int last_is_0;      //last character was '0'
+    uint8_t last_byte;  //last decoded byte, needed to undo a '0' low nibble followed by 'x'
+} printx_hexparse_t;
+
+static void printx_hexparse_init(printx_hexparse_t *p, uint8_t *out, size_t out_size){
+    p->out = out;
+    p->out_size = out_size;
+    p->n = 0;
+    p->nibble = -1;
+    p->last_is_0 = 0;
+    p->last_byte = 0;
+}
+static void printx_hexparse_feed(printx_hexparse_t *p, const void *chunk, size_t len){
+    const uint8_t *c = (const uint8_t*)chunk;
+    const uint8_t *const end = c+len;
+    while(c<end){
+        if(p->nibble<0){
+            //fast path: runs of hex digits without separators
+            const uint8_t *const start = c;
+#if !defined(PRINTX_NO_SIMD) && defined(__SSE2__)
+            while((c+32<=end) && (p->n+16<=p->out_size)){
+                int valid0,valid1;
+                const __m128i a = printx_hex_decode_sse2(_mm_loadu_si128((const __m128i*)c),&valid0);
+                const __m128i b = printx_hex_decode_sse2(_mm_loadu_si128((const __m128i*)(c+16)),&valid1);
+                if((0xFFFF!=valid0) || (0xFFFF!=valid1)) break;
+                _mm_storeu_si128((__m128i*)(p->out+p->n),_mm_packus_epi16(a,b));
+                p->n+=16;
+                c+=32;
+            }
+            if(c!=start) p->last_byte = ((printx_hex_values[c[-2]]-1)<<4) | (printx_hex_values[c[-1]]-1);
+#endif
+            while((c+2<=end) && printx_hex_values[c[0]] && printx_hex_values[c[1]]){
+                const uint8_t b = ((printx_hex_values[c[0]]-1)<<4) | (printx_hex_values[c[1]]-1);
+                if(p->n < p->out_size) p->out[p->n] = b;
+                p->n++;
+                p->last_byte = b;
+                c+=2;
+            }
+            if(c!=start) p->last_is_0 = '0'==c[-1];
+            if(c==end) break;
         }
-        printx_printf("\n");
-    }
-    const int remaining = size%bytes_per_line;
-    if(remaining){
-        printx_printf("%08x: ",base+(uint32_t)(uintptr_t)(pos-(const uint8_t*const)buf));
-        for(int j=0;j<remaining/bytes_per_word;j++) {
-            printx_bytes_sep("",pos,bytes_per_word," ","");
-            pos+=bytes_per_word;
+        const uint8_t v = printx_hex_values[*c];
+        if(v){
+            if(p->nibble<0){
+                p->nibble = v-1;
+            } else {
+                const uint8_t b = (p->nibble<<4) | (v-1);
+                if(p->n < p->out_size) p->out[p->n] = b;
+                p->n++;
+                p->last_byte = b;
+                p->nibble = -1;
+            }
+        } else if(p->last_is_0 && (('x'==*c) || ('X'==*c))){//undo the '0'
+            if(p->nibble>=0){
+                p->nibble = -1;
+            } else {
+                p->n--;
+                p->nibble = p->last_byte>>4;
+            }
         }
-        if(remaining%bytes_per_word){
-            printx_bytes_sep("",pos,remaining%bytes_per_word," ","");
+        p->last_is_0 = '0'==*c;
+        c++;
+    }
+}
+//returns the number of bytes stored in out, a trailing odd nibble is dropped
+//bytes of out after it may have been written: a "0x" can undo a byte already stored
+//p->n > out_size tells that the output was truncated
+static size_t printx_hexparse_finish(printx_hexparse_t *p){
+    p->nibble = -1;
+    p->last_is_0 = 0;
+    return p->n < p->out_size ? p->n : p->out_size;
+}
+
+//format one dump line in dst: "<addr>: <word> <word> ... \n", the last word may be partial
+//addr is printed with addr_digits lower case hex digits, dst shall hold printx_dump_line_max bytes
+//returns the length of the line
+static size_t printx_dump_line_max(size_t n, unsigned int addr_digits, unsigned int bytes_per_word){
+    return addr_digits + 2 + 2*n + (n+bytes_per_word-1)/bytes_per_word + 1;
+}
+static size_t printx_dump_line(char *dst, uint64_t addr, unsigned int addr_digits, const uint8_t *p, size_t n, unsigned int bytes_per_word){
+    static const char hex[16]={'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'};
+    char *d = dst;
+    for(unsigned int i=0;i<addr_digits;i++) d[i] = hex[(addr>>(4*(addr_digits-1-i))) & 0xF];
+    d += addr_digits;
+    *d++ = ':';
+    *d++ = ' ';
+    while(n){
+        const size_t w = n < bytes_per_word ? n : bytes_per_word;
+        for(size_t i=0;i<w;i++){
+            memcpy(d,printx_hex_pairs+2*p[i],2);
+            d+=2;
         }
-        printx_printf("\n");
+        *d++ = ' ';
+        p += w;
+        n -= w;
     }
+    *d++ = '\n';
+    return d-dst;
+}
+
+//same output as printx_dump_line, with one printx_printf per byte: for lines too long for any buffer
+static void printx_dump_line_printf(const char *prefix, uint64_t addr, unsigned int addr_digits, const uint8_t *p, size_t n, size_t bytes_per_word){
+    printx_printf("%s%0*llx: ",prefix,(int)addr_digits,(unsigned long long)addr);
+    for(size_t i=0;i<n;i++) printx_printf((i+1)%bytes_per_word && (i+1<n) ? "%02X" : "%02X ",p[i]);
+    printx_printf("\n");
+}
+
+//dump with one printx_write per block of lines instead of one printf per byte
+//addresses are base+offset, printed with addr_digits digits
+static void printx_dump_lines(const void*const buf, size_t size, uint64_t base, unsigned int addr_digits, size_t bytes_per_word, size_t words_per_line){
+    const size_t bytes_per_line = bytes_per_word*words_per_line;
+    const size_t line_max = printx_dump_line_max(bytes_per_line,addr_digits,bytes_per_word);
+    const uint8_t *pos = (const uint8_t*)buf;
+    char block[PRINTX_DUMP_BLOCK_SIZE];
+    char *line = line_max > sizeof(block) ? (char*)malloc(line_max) : 0;
+    size_t len = 0;
+    for(size_t offset=0;offset<size;offset+=bytes_per_line){
+        const size_t n = size-offset < bytes_per_line ? size-offset : bytes_per_line;
+        if(line_max > sizeof(block)){//line larger than the block
+            if(line) printx_write(line,printx_dump_line(line,base+offset,addr_digits,pos+offset,n,bytes_per_word));
+            else printx_dump_line_printf("",base+offset,addr_digits,pos+offset,n,bytes_per_word);
+            continue;
+        }
+        if(len+line_max > sizeof(block)){
+            printx_write(block,len);
+            len = 0;
+        }
+        len += printx_dump_line(block+len,base+offset,addr_digits,pos+offset,n,bytes_per_word);
+    }
+    if(len) printx_write(block,len);
+    free(line);
+}
+
+static void printx32_dump_buf(const char *msg,const void*const buf,size_t size,uint32_t base, int bytes_per_word,int words_per_line){
+    printx_printf("%s",msg);
+    printx_dump_lines(buf,size,base,8,bytes_per_word,words_per_line);
 }
 static void printx32_dump_buf32(const char *msg,const void*const buf,size_t size,uint32_t base){
     const int bytes_per_word=4;
@@ -145,11 +423,207 @@ static void printx32_dump_buf64(const char *msg,const void*const buf,size_t size
     printx32_dump_buf(msg,buf,size,base,bytes_per_word,words_per_line);
 }
 
+//same line format as printx32_dump_buf but with 16 digit addresses, for buffers above 4GB
+static void printx64_dump_buf(const char *msg,const void*const buf,size_t size,uint64_t base, size_t bytes_per_word,size_t words_per_line){
+    printx_printf("%s",msg);
+    printx_dump_lines(buf,size,base,16,bytes_per_word,words_per_line);
+}
+static void printx64_dump_buf32(const char *msg,const void*const buf,size_t size,uint64_t base){
+    printx64_dump_buf(msg,buf,size,base,4,64/4);
+}
+static void printx64_dump_buf64(const char *msg,const void*const buf,size_t size,uint64_t base){
+    printx64_dump_buf(msg,buf,size,base,8,64/8);
+}
+
+#ifdef PRINTX_HAS_PTHREAD
+typedef struct printx_dump_chunk_struct {
+    const uint8_t *src;
+    size_t size;
+    uint64_t base;
+    size_t bytes_per_word;
+    size_t bytes_per_line;
+    char *text;         //PRINTX_DUMP_CHUNK_LINES lines
+    size_t len;
+    pthread_t thread;
+    int running;
+} printx_dump_chunk_t;
+
+static void *printx_dump_chunk_run(void *arg){
+    printx_dump_chunk_t *c = (printx_dump_chunk_t*)arg;
+    size_t len = 0;
+    for(size_t offset=0;offset<c->size;offset+=c->bytes_per_line){
+        const size_t n = c->size-offset < c->bytes_per_line ? c->size-offset : c->bytes_per_line;
+        len += printx_dump_line(c->text+len,c->base+offset,16,c->src+offset,n,c->bytes_per_word);
+    }
+    c->len = len;
+    return 0;
+}
+
+//printx64_dump_buf using n_threads workers
+//the buffer is cut in chunks of PRINTX_DUMP_CHUNK_LINES lines, each round formats n_threads chunks
+//while the previous round is written in order, so the output is identical to printx64_dump_buf
+static void printx64_dump_buf_mt(const char *msg,const void*const buf,size_t size,uint64_t base, size_t bytes_per_word,size_t words_per_line, unsigned int n_threads){
+    const size_t bytes_per_line = bytes_per_word*words_per_line;
+    const size_t chunk_size = bytes_per_line*PRINTX_DUMP_CHUNK_LINES;
+    const size_t text_size = printx_dump_line_max(bytes_per_line,16,bytes_per_word)*PRINTX_DUMP_CHUNK_LINES;
+    if((n_threads<2) || (size<=chunk_size)){
+        printx64_dump_buf(msg,buf,size,base,bytes_per_word,words_per_line);
+        return;
+    }
+    const size_t n_chunks = (size+chunk_size-1)/chunk_size;
+    if(n_threads>n_chunks) n_threads = n_chunks;
+    //two sets of n_threads chunks: one being formatted, one being written
+    printx_dump_chunk_t *chunks = (printx_dump_chunk_t*)calloc(2*n_threads,sizeof(printx_dump_chunk_t));
+    char *text = chunks ? (char*)malloc(2*n_threads*text_size) : 0;
+    if(0==text){
+        free(chunks);
+        printx64_dump_buf(msg,buf,size,base,bytes_per_word,words_per_line);
+        return;
+    }
+    printx_printf("%s",msg);
+    const uint8_t *src = (const uint8_t*)buf;
+    size_t next = 0;//next chunk to start
+    for(unsigned int round=0;;round++){
+        //start the round
+        printx_dump_chunk_t *set = chunks + (round&1)*n_threads;
+        for(unsigned int t=0;(t<n_threads) && (next<n_chunks);t++,next++){
+            printx_dump_chunk_t *c = set+t;
+            const size_t offset = next*chunk_size;
+            c->src = src+offset;
+            c->size = size-offset < chunk_size ? size-offset : chunk_size;
+            c->base = base+offset;
+            c->bytes_per_word = bytes_per_word;
+            c->bytes_per_line = bytes_per_line;
+            c->text = text + (set-chunks+t)*text_size;
+            c->running = 0==pthread_create(&c->thread,0,printx_dump_chunk_run,c);
+            if(!c->running) printx_dump_chunk_run(c);
+        }
+        //write the previous round
+        if(round){
+            printx_dump_chunk_t *prev = chunks + ((round-1)&1)*n_threads;
+            for(unsigned int t=0;t<n_threads;t++){
+                printx_dump_chunk_t *c = prev+t;
+                if(0==c->text) break;
+                if(c->running) pthread_join(c->thread,0);
+                printx_write(c->text,c->len);
+                c->text = 0;
+            }
+        }
+        if(0==set->text) break;//nothing started
+    }
+    free(text);
+    free(chunks);
+}
+#endif
+
+//return the offset of the first byte at or after offset which differs between a and b, size if there is none
+//identical regions are skipped with memcmp, the differing chunk is scanned 8 bytes at a time
+static size_t printx_diff_next(const void *va, const void *vb, size_t size, size_t offset){
+    const uint8_t *a = (const uint8_t*)va;
+    const uint8_t *b = (const uint8_t*)vb;
+    const size_t chunk = 4096;
+    while(offset<size){
+        const size_t n = size-offset < chunk ? size-offset : chunk;
+        if(0==memcmp(a+offset,b+offset,n)){
+            offset += n;
+            continue;
+        }
+        for(;offset+8<=size;offset+=8){
+            uint64_t x,y;
+            memcpy(&x,a+offset,8);
+            memcpy(&y,b+offset,8);
+            if(x!=y) break;
+        }
+        while(a[offset]==b[offset]) offset++;
+        return offset;
+    }
+    return size;
+}
+
+//print the lines which differ between a and b in printx32_dump_buf format:
+//  @@ <first differing address> - <last differing address> @@
+//    <line identical in a and b>  (up to context lines before and after differing lines)
+//  - <line of a>
+//  + <line of b>
+//returns the number of differing bytes
+static size_t printx32_diff_buf(const char *msg, const void*const a, const void*const b, size_t size, uint32_t base, int bytes_per_word, int words_per_line, unsigned int context){
+    const uint8_t *a8 = (const uint8_t*)a;
+    const uint8_t *b8 = (const uint8_t*)b;
+    const size_t bytes_per_line = bytes_per_word*words_per_line;
+    const size_t n_lines = (size+bytes_per_line-1)/bytes_per_line;
+    const size_t line_max = 2+printx_dump_line_max(bytes_per_line,8,bytes_per_word);
+    char block[PRINTX_DUMP_BLOCK_SIZE];
+    char *const heap = line_max > sizeof(block) ? (char*)malloc(line_max) : 0;
+    char *const line = line_max > sizeof(block) ? heap : block;//0 if the allocation failed
+    size_t n_diff = 0;
+    printx_printf("%s",msg);
+    size_t d = printx_diff_next(a,b,size,0);
+    while(d<size){
+        //a hunk covers lines [first,last], differing lines closer than 2*context+1 are merged
+        const size_t first = d/bytes_per_line > context ? d/bytes_per_line - context : 0;
+        size_t last_diff_line = d/bytes_per_line;
+        size_t last_diff = d;
+        size_t hunk_diff = 0;
+        const size_t first_diff = d;
+        while(d<size && d/bytes_per_line <= last_diff_line+2*context+1){
+            last_diff_line = d/bytes_per_line;
+            const size_t line_end = (last_diff_line+1)*bytes_per_line < size ? (last_diff_line+1)*bytes_per_line : size;
+            for(size_t i=d;i<line_end;i++){
+                if(a8[i]!=b8[i]){
+                    hunk_diff++;
+                    last_diff = i;
+                }
+            }
+            d = printx_diff_next(a,b,size,line_end);
+        }
+        const size_t last = last_diff_line+context < n_lines-1 ? last_diff_line+context : n_lines-1;
+        n_diff += hunk_diff;
+        printx_printf("@@ %08x - %08x @@\n",(uint32_t)(base+first_diff),(uint32_t)(base+last_diff));
+        for(size_t l=first;l<=last;l++){
+            const size_t offset = l*bytes_per_line;
+            const size_t n = size-offset < bytes_per_line ? size-offset : bytes_per_line;
+            const int same = 0==memcmp(a8+offset,b8+offset,n);
+            if(0==line){
+                printx_dump_line_printf(same ? "  " : "- ",(uint32_t)(base+offset),8,a8+offset,n,bytes_per_word);
+                if(!same) printx_dump_line_printf("+ ",(uint32_t)(base+offset),8,b8+offset,n,bytes_per_word);
+            } else if(same){
+                memcpy(line,"  ",2);
+                printx_write(line,2+printx_dump_line(line+2,(uint32_t)(base+offset),8,a8+offset,n,bytes_per_word));
+            } else {
+                memcpy(line,"- ",2);
+                printx_write(line,2+printx_dump_line(line+2,(uint32_t)(base+offset),8,a8+offset,n,bytes_per_word));
+                memcpy(line,"+ ",2);
+                printx_write(line,2+printx_dump_line(line+2,(uint32_t)(base+offset),8,b8+offset,n,bytes_per_word));
+            }
+        }
+    }
+    free(heap);
+    return n_diff;
+}
+static size_t printx32_diff_buf32(const char *msg, const void*const a, const void*const b, size_t size, uint32_t base, unsigned int context){
+    return printx32_diff_buf(msg,a,b,size,base,4,64/4,context);
+}
+static size_t printx32_diff_buf64(const char *msg, const void*const a, const void*const b, size_t size, uint32_t base, unsigned int context){
+    return printx32_diff_buf(msg,a,b,size,base,8,64/8,context);
+}
+
 static void printx_remove_unused_warnings(void){
     (void)printxln_bytes;
     (void)printxln_128;
     (void)printx_bytes_to_hexstr;
+    (void)printx_hex_encode;
+    (void)printx_hex_decode;
+    (void)printx64_dump_buf32;
+    (void)printx64_dump_buf64;
+#ifdef PRINTX_HAS_PTHREAD
+    (void)printx64_dump_buf_mt;
+#endif
+    (void)printx32_diff_buf32;
+    (void)printx32_diff_buf64;
     (void)printx_user_hexstr_to_bytes;
+    (void)printx_hexparse_init;
+    (void)printx_hexparse_feed;
+    (void)printx_hexparse_finish;
     (void)printx_diff_bytes_sep;
 }
 
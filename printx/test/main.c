@@ -0,0 +1,362 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+//capture everything printed by printx
+static char *out;
+static size_t out_len;
+static size_t out_cap;
+static int capture_printf(const char *fmt, ...){
+    va_list ap;
+    va_start(ap,fmt);
+    const int n = vsnprintf(0,0,fmt,ap);
+    va_end(ap);
+    if(out_len+n+1>out_cap){
+        out_cap = 2*(out_len+n+1);
+        out = (char*)realloc(out,out_cap);
+    }
+    va_start(ap,fmt);
+    vsnprintf(out+out_len,n+1,fmt,ap);
+    va_end(ap);
+    out_len += n;
+    return n;
+}
+#define printx_printf capture_printf
+//small chunks to exercise many rounds of printx64_dump_buf_mt
+#define PRINTX_DUMP_CHUNK_LINES 3
+#define PRINTX_HAS_PTHREAD
+#include "printx.h"
+
+//former printf based implementation, kept as reference
+static void ref_dump_buf(const char *msg,const void*const buf,size_t size,uint32_t base, int bytes_per_word,int words_per_line){
+    const int bytes_per_line=bytes_per_word*words_per_line;
+    const uint8_t*pos=(const uint8_t*)buf;
+    printx_printf("%s",msg);
+    for(int i=0;i<size/bytes_per_line;i++){
+        printx_printf("%08x: ",base+(uint32_t)(uintptr_t)(pos-(const uint8_t*const)buf));
+        for(int j=0;j<words_per_line;j++) {
+            printx_bytes_sep("",pos,bytes_per_word," ","");
+            pos+=bytes_per_word;
+        }
+        printx_printf("\n");
+    }
+    const int remaining = size%bytes_per_line;
+    if(remaining){
+        printx_printf("%08x: ",base+(uint32_t)(uintptr_t)(pos-(const uint8_t*const)buf));
+        for(int j=0;j<remaining/bytes_per_word;j++) {
+            printx_bytes_sep("",pos,bytes_per_word," ","");
+            pos+=bytes_per_word;
+        }
+        if(remaining%bytes_per_word){
+            printx_bytes_sep("",pos,remaining%bytes_per_word," ","");
+        }
+        printx_printf("\n");
+    }
+}
+
+static char *take_output(void){
+    char *s = out;
+    out = 0;
+    out_len = out_cap = 0;
+    return s ? s : calloc(1,1);
+}
+
+static void dump_test(void){
+    const size_t max_size = 3000;
+    uint8_t *buf = (uint8_t*)malloc(max_size);
+    for(size_t i=0;i<max_size;i++) buf[i] = rand();
+    const int geometries[][2] = {{4,16},{8,8},{1,1},{3,5},{16,1},{1,2000}};
+    const uint32_t bases[] = {0,0x1000,0xFFFFFFF0};
+    for(unsigned int g=0;g<sizeof(geometries)/sizeof(geometries[0]);g++){
+        for(unsigned int b=0;b<sizeof(bases)/sizeof(bases[0]);b++){
+            for(size_t size=0;size<max_size;size+=size<300 ? 1 : 97){
+                ref_dump_buf("msg\n",buf,size,bases[b],geometries[g][0],geometries[g][1]);
+                char *expected = take_output();
+                printx32_dump_buf("msg\n",buf,size,bases[b],geometries[g][0],geometries[g][1]);
+                char *result = take_output();
+                assert(0==strcmp(expected,result));
+                free(expected);
+                free(result);
+            }
+        }
+    }
+    printx32_dump_buf32("",buf,100,0x20);
+    char *result = take_output();
+    ref_dump_buf("",buf,100,0x20,4,16);
+    char *expected = take_output();
+    assert(0==strcmp(expected,result));
+    free(expected);
+    free(result);
+    printx32_dump_buf64("",buf,100,0x20);
+    result = take_output();
+    ref_dump_buf("",buf,100,0x20,8,8);
+    expected = take_output();
+    assert(0==strcmp(expected,result));
+    free(expected);
+    free(result);
+    //fallback used when no line buffer can be allocated
+    for(size_t n=0;n<40;n++){
+        for(size_t bpw=1;bpw<=8;bpw++){
+            char line[128];
+            const size_t len = printx_dump_line(line,0x123456789AULL,16,buf,n,bpw);
+            line[len] = 0;
+            printx_dump_line_printf("",0x123456789AULL,16,buf,n,bpw);
+            result = take_output();
+            assert(0==strcmp(line,result));
+            free(result);
+        }
+    }
+    free(buf);
+    printf("dump_test PASS\n");
+}
+
+//prefix each line of a printx32_dump_buf output with 8 zeros: printx64_dump_buf output for a base below 4GB
+static char *widen_addresses(const char *dump, size_t msg_len){
+    size_t lines = 0;
+    for(const char *c=dump+msg_len;*c;c++) lines += '\n'==*c;
+    char *wide = (char*)malloc(strlen(dump)+8*lines+1);
+    char *d = wide;
+    memcpy(d,dump,msg_len);
+    d+=msg_len;
+    int line_start = 1;
+    for(const char *c=dump+msg_len;*c;c++){
+        if(line_start){
+            memcpy(d,"00000000",8);
+            d+=8;
+        }
+        *d++ = *c;
+        line_start = '\n'==*c;
+    }
+    *d = 0;
+    return wide;
+}
+
+static void dump64_test(void){
+    const size_t max_size = 3000;
+    uint8_t *buf = (uint8_t*)malloc(max_size);
+    for(size_t i=0;i<max_size;i++) buf[i] = rand();
+    const size_t geometries[][2] = {{4,16},{8,8},{1,1},{3,5}};
+    for(unsigned int g=0;g<sizeof(geometries)/sizeof(geometries[0]);g++){
+        for(size_t size=0;size<max_size;size+=size<300 ? 1 : 97){
+            ref_dump_buf("msg\n",buf,size,0x1000,geometries[g][0],geometries[g][1]);
+            char *ref = take_output();
+            char *expected = widen_addresses(ref,4);
+            printx64_dump_buf("msg\n",buf,size,0x1000,geometries[g][0],geometries[g][1]);
+            char *result = take_output();
+            assert(0==strcmp(expected,result));
+            free(result);
+            for(unsigned int n_threads=1;n_threads<6;n_threads++){
+                printx64_dump_buf_mt("msg\n",buf,size,0x1000,geometries[g][0],geometries[g][1],n_threads);
+                result = take_output();
+                assert(0==strcmp(expected,result));
+                free(result);
+            }
+            free(expected);
+            free(ref);
+        }
+    }
+    //addresses above 4GB
+    printx64_dump_buf_mt("",buf,200,0xFFFFFFFFC0ULL,4,16,3);
+    char *result = take_output();
+    assert(0==strncmp(result,"000000ffffffffc0: ",18));
+    const char *line = strchr(result,'\n')+1;
+    assert(0==strncmp(line,"0000010000000000: ",18));
+    line = strchr(line,'\n')+1;
+    assert(0==strncmp(line,"0000010000000040: ",18));
+    free(result);
+    printx64_dump_buf64("",buf,100,0x20);
+    result = take_output();
+    ref_dump_buf("",buf,100,0x20,8,8);
+    char *ref = take_output();
+    char *expected = widen_addresses(ref,0);
+    assert(0==strcmp(expected,result));
+    free(expected);
+    free(ref);
+    free(result);
+    free(buf);
+    printf("dump64_test PASS\n");
+}
+
+static void hex_test(void){
+    const size_t max_size = 300;
+    uint8_t *buf = (uint8_t*)malloc(max_size);
+    uint8_t *dec = (uint8_t*)malloc(max_size+1);
+    char *hex = (char*)malloc(2*max_size+2);
+    char *ref = (char*)malloc(2*max_size+2);
+    const char bad_chars[] = {'/',':','@','G','`','g',' ',0,(char)0x80,(char)0xB0,(char)0xC1,(char)0xFF};
+    for(size_t size=0;size<max_size;size++){
+        for(size_t i=0;i<size;i++) buf[i] = rand();
+        ref[0]=0;
+        printx_bytes_to_hexstr(ref,buf,size);
+        memset(hex,0x55,2*max_size+2);
+        const size_t encoded = printx_hex_encode(hex,buf,size);
+        assert(2*size==encoded);
+        assert(0==memcmp(hex,ref,2*size+0));
+        assert(0x55==(uint8_t)hex[2*size]);//nothing written after the digits
+        for(size_t i=0;i<2*size;i++) if(rand()&1) hex[i] = tolower(hex[i]);
+        size_t bad_pos = 12345;
+        memset(dec,0xAA,max_size+1);
+        int status = printx_hex_decode(dec,hex,2*size,&bad_pos);
+        assert(0==status);
+        assert(12345==bad_pos);
+        assert(0==memcmp(dec,buf,size));
+        assert(0xAA==dec[size]);
+        if(0==size) continue;
+        //odd length
+        status = printx_hex_decode(dec,hex,2*size-1,&bad_pos);
+        assert(-1==status);
+        assert(2*size-2==bad_pos);
+        assert(0==memcmp(dec,buf,size-1));
+        //first bad character is reported
+        for(unsigned int k=0;k<4;k++){
+            const size_t pos = rand()%(2*size);
+            const size_t pos2 = pos + rand()%(2*size-pos);
+            const char saved = hex[pos];
+            const char saved2 = hex[pos2];
+            hex[pos2] = bad_chars[rand()%sizeof(bad_chars)];
+            hex[pos] = bad_chars[rand()%sizeof(bad_chars)];
+            status = printx_hex_decode(dec,hex,2*size,&bad_pos);
+            assert(-1==status);
+            assert(pos==bad_pos);
+            assert(0==memcmp(dec,buf,pos/2));
+            hex[pos] = saved;
+            hex[pos2] = saved2;
+        }
+    }
+    //every character value
+    for(unsigned int c=0;c<256;c++){
+        char s[2]={'0',(char)c};
+        size_t bad_pos=0;
+        const int status = printx_hex_decode(dec,s,2,&bad_pos);
+        assert((0==status) == (-1!=printx_hexdigit_value((char)c)));
+        if(0==status) assert(dec[0]==printx_hexdigit_value((char)c));
+        else assert(1==bad_pos);
+    }
+    free(buf);
+    free(dec);
+    free(hex);
+    free(ref);
+    printf("hex_test PASS\n");
+}
+
+static void hexparse_test(void){
+    const size_t max_len = 700;
+    const char alphabet[] = "0123456789abcdefABCDEF00000xXxX :,\n\tgz-";
+    char *str = (char*)malloc(max_len+1);
+    char *ref_str = (char*)malloc(max_len+1);
+    uint8_t *ref = (uint8_t*)malloc(max_len);
+    uint8_t *dec = (uint8_t*)malloc(max_len+1);
+    for(unsigned int k=0;k<20000;k++){
+        const size_t len = rand()%max_len;
+        //mostly hex digits, to exercise the fast path and long runs
+        const unsigned int sep_rate = 1+rand()%64;
+        for(size_t i=0;i<len;i++){
+            if(rand()%sep_rate) str[i] = alphabet[rand()%22];
+            else str[i] = alphabet[rand()%(sizeof(alphabet)-1)];
+        }
+        str[len] = 0;
+        memcpy(ref_str,str,len+1);
+        const size_t out_size = rand()%(len/2+2);
+        memset(ref,0xAA,max_len);
+        const size_t ref_n = printx_user_hexstr_to_bytes(ref,out_size,ref_str,len+1);
+        //random chunking, including empty chunks
+        printx_hexparse_t p;
+        memset(dec,0xAA,max_len+1);
+        printx_hexparse_init(&p,dec,out_size);
+        size_t pos = 0;
+        while(pos<len){
+            const size_t chunk = rand()%4 ? rand()%8 : rand()%(len-pos+1);
+            const size_t n = chunk < len-pos ? chunk : len-pos;
+            printx_hexparse_feed(&p,str+pos,n);
+            pos+=n;
+        }
+        size_t dec_n = printx_hexparse_finish(&p);
+        assert(ref_n==dec_n);
+        assert(0==memcmp(dec,ref,ref_n));
+        assert(0xAA==dec[out_size]);
+        //single chunk
+        memset(dec,0xAA,max_len+1);
+        printx_hexparse_init(&p,dec,out_size);
+        printx_hexparse_feed(&p,str,len);
+        dec_n = printx_hexparse_finish(&p);
+        assert(ref_n==dec_n);
+        assert(0==memcmp(dec,ref,ref_n));
+        assert(0xAA==dec[out_size]);
+    }
+    free(str);
+    free(ref_str);
+    free(ref);
+    free(dec);
+    printf("hexparse_test PASS\n");
+}
+
+static void diff_test(void){
+    const size_t size = 100000;
+    uint8_t *a = (uint8_t*)malloc(size);
+    uint8_t *b = (uint8_t*)malloc(size);
+    for(size_t i=0;i<size;i++) a[i] = rand();
+    for(unsigned int k=0;k<200;k++){
+        memcpy(b,a,size);
+        const unsigned int n = rand()%20;
+        for(unsigned int j=0;j<n;j++) b[rand()%size] ^= 1+rand()%255;
+        //reference: byte by byte
+        size_t expected_diff = 0;
+        size_t next = 0;
+        for(size_t i=0;i<size;i++){
+            if(a[i]!=b[i]){
+                expected_diff++;
+                assert(i==printx_diff_next(a,b,size,next));
+                next = i+1;
+            }
+        }
+        assert(size==printx_diff_next(a,b,size,next));
+        const size_t n_diff = printx32_diff_buf32("",a,b,size,0,k%3);
+        assert(expected_diff==n_diff);
+        free(take_output());
+    }
+    //output format
+    memcpy(b,a,size);
+    b[0x45] ^= 0xFF;
+    b[0x47] ^= 0x0F;
+    b[0x2C5] ^= 0x01;
+    size_t n_diff = printx32_diff_buf32("diff\n",a,b,0x300,0x1000,1);
+    assert(3==n_diff);
+    char *result = take_output();
+    char *expected = (char*)calloc(1,4096);
+    strcat(expected,"diff\n");
+    strcat(expected,"@@ 00001045 - 00001047 @@\n");
+    printx32_dump_buf32("",a,0x40,0x1000);strcat(expected,"  ");strcat(expected,out);free(take_output());
+    printx32_dump_buf32("",a+0x40,0x40,0x1040);strcat(expected,"- ");strcat(expected,out);free(take_output());
+    printx32_dump_buf32("",b+0x40,0x40,0x1040);strcat(expected,"+ ");strcat(expected,out);free(take_output());
+    printx32_dump_buf32("",a+0x80,0x40,0x1080);strcat(expected,"  ");strcat(expected,out);free(take_output());
+    strcat(expected,"@@ 000012c5 - 000012c5 @@\n");
+    printx32_dump_buf32("",a+0x280,0x40,0x1280);strcat(expected,"  ");strcat(expected,out);free(take_output());
+    printx32_dump_buf32("",a+0x2C0,0x40,0x12C0);strcat(expected,"- ");strcat(expected,out);free(take_output());
+    printx32_dump_buf32("",b+0x2C0,0x40,0x12C0);strcat(expected,"+ ");strcat(expected,out);free(take_output());
+    assert(0==strcmp(expected,result));
+    free(result);
+    free(expected);
+    //no difference, nothing printed
+    n_diff = printx32_diff_buf64("",a,a,size,0,3);
+    assert(0==n_diff);
+    result = take_output();
+    assert(0==strlen(result));
+    free(result);
+    free(a);
+    free(b);
+    printf("diff_test PASS\n");
+}
+
+int main(int argc, char *argv[]){
+    (void)argc;(void)argv;
+    (void)printx_remove_unused_warnings;
+    dump_test();
+    dump64_test();
+    hex_test();
+    hexparse_test();
+    diff_test();
+    printf("TEST PASS\n");
+}